@@ -0,0 +1,388 @@
+#include <malloc.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avl.h"
+#include "hash_table.h"
+#include "binary_heap.h"
+
+// Microbenchmarks of the modules, at sizes 10^3, 10^4, ... up to the size given (10^6 by default).
+// Every result is a tab separated line:
+//
+//   module  op  dist  n  ns_per_op  bytes_per_elem
+//
+// `ns_per_op` is the time of one operation (for iterations, of one element visited),
+// `bytes_per_elem` the heap memory of the structure divided by its elements.
+//
+// Keys follow the distributions of the app's data:
+//   dates        entries in date order, a few per day, as read from the input files
+//   countries    skewed: few countries get most of the records (Zipf, s = 1)
+//   record_ids   random record IDs
+
+#define BENCH_MIN_N 1000
+#define BENCH_DEF_MAX_N 1000000
+
+#define BENCH_OPS 1000000        // Operations timed per size; builds are repeated up to this many elements.
+#define BENCH_RANGES 10000       // Range iterations per size.
+#define BENCH_RANGE_LEN 100      // Elements visited per range.
+#define BENCH_DAYS 3650          // Days spanned by the date-ordered keys.
+#define BENCH_COUNTRIES 200      // Countries of the skewed keys.
+#define BENCH_TOPK 10
+
+#define BENCH_HT_BUCKETS 16      // The hts start small and grow, as the app's do.
+#define BENCH_HT_BUCKET_SIZE (8 * MIN_ACCEPTABLE_BUCKET_SIZE)
+// Bounds on the probes of a successful search of sequential ids, up to a load factor of 3/4
+// with a migration in progress.
+#define BENCH_MAX_AVG_PROBES 4.0
+#define BENCH_MAX_PROBES 48
+
+enum dist { DATES, COUNTRIES, RECORD_IDS, NUM_DISTS };
+
+static const char *dist_names[NUM_DISTS] = { "dates", "countries", "record_ids" };
+
+/* ========================================================================= */
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15u;
+
+// splitmix64: `mix` is a bijection, so the mix of distinct values gives distinct random keys.
+static uint64_t mix(uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31);
+}
+
+static uint64_t rng(void) {
+  return mix(rng_state += 0x9e3779b97f4a7c15u);
+}
+
+// Random rank in [0, n), skewed: rank r is drawn with probability ~ 1 / (r + 1).
+static uint64_t zipf(uint64_t n)
+{
+  double u = (rng() >> 11) * (1.0 / 9007199254740992.0);  // Uniform in [0, 1).
+  uint64_t r = (uint64_t)exp(u * log((double)n + 1)) - 1;
+  return r < n ? r : n - 1;
+}
+
+// Index of the element an operation is made on: skewed for `COUNTRIES`, uniform otherwise.
+static uint64_t pick(enum dist d, uint64_t n) {
+  return d == COUNTRIES ? zipf(n) : rng() % n;
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Heap memory in use, in bytes.
+static double heap_bytes(void)
+{
+  struct mallinfo2 mi = mallinfo2();
+  return (double)mi.uordblks + mi.hblkhd;
+}
+
+static void report(const char *module, const char *op, enum dist d, long n, double ns_per_op, double bytes_per_elem)
+{
+  printf("%s\t%s\t%s\t%ld\t%.1f\t%.1f\n", module, op, dist_names[d], n, ns_per_op, bytes_per_elem);
+  fflush(stdout);
+}
+
+// Times a build of `n` elements is repeated, so every size times about `BENCH_OPS` elements.
+static long repeats(long n) {
+  return n < BENCH_OPS ? BENCH_OPS / n : 1;
+}
+
+/* ========================================================================= */
+
+// Key `i` of `n`, as an integer. Distinct for distinct `i`.
+static uint64_t make_key(enum dist d, uint64_t i, uint64_t n)
+{
+  switch (d)
+  {
+    case DATES:
+      return (i * BENCH_DAYS / n) << 32 | i;   // Day, then order of entry.
+    case COUNTRIES:
+      return zipf(BENCH_COUNTRIES) << 32 | i;  // Country, then order of entry.
+    case RECORD_IDS:
+    default:
+      return mix(i);
+  }
+}
+
+// Key `i`, as a string, written in `buf`.
+static void make_str_key(char *buf, size_t size, enum dist d, uint64_t i, uint64_t n)
+{
+  uint64_t day = i * BENCH_DAYS / n;
+
+  switch (d)
+  {
+    case DATES:
+      snprintf(buf, size, "%02d-%02d-%04d#%lu", (int)(day % 28 + 1), (int)(day / 28 % 12 + 1), (int)(2000 + day / 336), (unsigned long)i);
+      break;
+    case COUNTRIES:  // Lookups are skewed towards the first ones.
+      snprintf(buf, size, "Country%lu", (unsigned long)i);
+      break;
+    case RECORD_IDS:
+    default:
+      snprintf(buf, size, "%lu", (unsigned long)mix(i));
+  }
+}
+
+static int compare_keys(void *a, void *b)
+{
+  uint64_t k1 = *(uint64_t *)a, k2 = *(uint64_t *)b;
+  return (k1 > k2) - (k1 < k2);
+}
+
+static int compare_key_ptrs(const void *a, const void *b) {
+  return compare_keys(*(void **)a, *(void **)b);
+}
+
+static uint64_t *make_keys(enum dist d, long n)
+{
+  uint64_t *keys = malloc(n * sizeof(uint64_t));
+  for (long i = 0; i < n; ++i)
+    keys[i] = make_key(d, i, n);
+  return keys;
+}
+
+/* ========================================================================= */
+
+static void bench_avl(enum dist d, long n)
+{
+  uint64_t *keys = make_keys(d, n);
+  long reps = repeats(n);
+  struct avl *tree = NULL;
+  double bytes = 0, elapsed = 0;
+
+  for (long r = 0; r < reps; ++r)  // The tree of the last repetition is kept for the other operations.
+  {
+    if (tree != NULL)
+      avl_destroy(tree);
+
+    double mem = heap_bytes();
+    tree = avl_create(compare_keys, NULL);
+
+    double t = now_ns();
+    for (long i = 0; i < n; ++i)
+      avl_insert(tree, &keys[i]);
+    elapsed += now_ns() - t;
+
+    bytes = (heap_bytes() - mem) / n;
+  }
+  report("avl", "insert", d, n, elapsed / (reps * n), bytes);
+
+  long found = 0;
+  double t = now_ns();
+  for (long i = 0; i < BENCH_OPS; ++i)
+    found += avl_find_node(tree, &keys[pick(d, n)]) != NULL;
+  report("avl", "search", d, n, (now_ns() - t) / BENCH_OPS, bytes);
+
+  long visited = 0;
+  t = now_ns();
+  for (long i = 0; i < BENCH_RANGES; ++i)
+  {
+    struct avl_node *node = avl_lower_bound(tree, &keys[pick(d, n)]);
+    for (int j = 0; node != NULL && j < BENCH_RANGE_LEN; ++j, ++visited)
+      node = avl_next(tree, node);
+  }
+  report("avl", "range_iterate", d, n, (now_ns() - t) / visited, bytes);
+
+  visited = 0;
+  t = now_ns();
+  for (long r = 0; r < reps; ++r)
+    for (struct avl_node *node = avl_first(tree); node != NULL; node = avl_next(tree, node))
+      ++visited;
+  report("avl", "traverse", d, n, (now_ns() - t) / visited, bytes);
+
+  avl_destroy(tree);
+
+  // Bulk build from the keys in order, as the loaders do.
+  void **sorted = malloc(n * sizeof(void *));
+  for (long i = 0; i < n; ++i)
+    sorted[i] = &keys[i];
+  qsort(sorted, n, sizeof(void *), compare_key_ptrs);
+
+  elapsed = 0;
+  for (long r = 0; r < reps; ++r)
+  {
+    tree = avl_create(compare_keys, NULL);
+    t = now_ns();
+    avl_build_sorted(tree, sorted, n);
+    elapsed += now_ns() - t;
+    avl_destroy(tree);
+  }
+  report("avl", "build_sorted", d, n, elapsed / (reps * n), bytes);
+
+  if (found != BENCH_OPS)
+    fprintf(stderr, "avl: %ld of %d keys not found\n", BENCH_OPS - found, BENCH_OPS);
+
+  free(sorted);
+  free(keys);
+}
+
+/* ========================================================================= */
+
+#define BENCH_KEY_LEN 32
+
+static void bench_hash_table(enum dist d, long n)
+{
+  char *keys = malloc(n * BENCH_KEY_LEN);
+  for (long i = 0; i < n; ++i)
+    make_str_key(keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN, d, i, n);
+
+  long reps = repeats(n);
+  struct hash_table *ht = NULL;
+  double bytes = 0, elapsed = 0;
+
+  for (long r = 0; r < reps; ++r)
+  {
+    if (ht != NULL)
+      ht_destroy(ht);
+
+    double mem = heap_bytes();
+    ht = ht_create(BENCH_HT_BUCKETS, BENCH_HT_BUCKET_SIZE, NULL);
+
+    double t = now_ns();
+    for (long i = 0; i < n; ++i)
+      ht_insert(ht, keys + i * BENCH_KEY_LEN, keys + i * BENCH_KEY_LEN);
+    elapsed += now_ns() - t;
+
+    bytes = (heap_bytes() - mem) / n;
+  }
+  report("hash_table", "insert", d, n, elapsed / (reps * n), bytes);
+
+  long found = 0;
+  double t = now_ns();
+  for (long i = 0; i < BENCH_OPS; ++i)
+    found += ht_search(ht, keys + pick(d, n) * BENCH_KEY_LEN) != NULL;
+  report("hash_table", "search", d, n, (now_ns() - t) / BENCH_OPS, bytes);
+
+  long visited = 0;
+  t = now_ns();
+  for (long r = 0; r < reps; ++r)
+  {
+    struct ht_iter it;
+    ht_iter_init(&it, ht);
+    while (ht_iter_next(&it) != NULL)
+      ++visited;
+  }
+  report("hash_table", "traverse", d, n, (now_ns() - t) / visited, bytes);
+
+  if (found != BENCH_OPS)
+    fprintf(stderr, "hash_table: %ld of %d keys not found\n", BENCH_OPS - found, BENCH_OPS);
+
+  ht_destroy(ht);
+  free(keys);
+}
+
+struct probe_stats { long searches, probes, max; };
+
+static void add_probes(void *arg, int probes)
+{
+  struct probe_stats *ps = arg;
+  ++ps->searches;
+  ps->probes += probes;
+  if (probes > ps->max)
+    ps->max = probes;
+}
+
+// Probe lengths of `n` sequential ids ("1", "2", ...), as the app's record ids usually are.
+// Returns false, if they show that the hash clusters such keys.
+static bool check_ht_probes(long n)
+{
+  char *keys = malloc(n * BENCH_KEY_LEN);
+  struct hash_table *ht = ht_create(BENCH_HT_BUCKETS, BENCH_HT_BUCKET_SIZE, NULL);
+  for (long i = 0; i < n; ++i)
+  {
+    snprintf(keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN, "%ld", i + 1);
+    ht_insert(ht, keys + i * BENCH_KEY_LEN, keys + i * BENCH_KEY_LEN);
+  }
+
+  struct probe_stats ps = { 0, 0, 0 };
+  ht_set_probe_hook(ht, add_probes, &ps);
+  for (long i = 0; i < n; ++i)
+    ht_search(ht, keys + i * BENCH_KEY_LEN);
+
+  double avg = (double)ps.probes / ps.searches;
+  bool ok = avg <= BENCH_MAX_AVG_PROBES && ps.max <= BENCH_MAX_PROBES;
+  if (!ok)
+    fprintf(stderr, "hash_table: sequential ids, n = %ld: %.2f avg / %ld max probes\n", n, avg, ps.max);
+
+  ht_destroy(ht);
+  free(keys);
+  return ok;
+}
+
+/* ========================================================================= */
+
+static void bench_binary_heap(enum dist d, long n)
+{
+  uint64_t *keys = make_keys(d, n);
+  long reps = repeats(n);
+  double bytes = 0, insert = 0, extract = 0, topk = 0;
+
+  for (long r = 0; r < reps; ++r)
+  {
+    double mem = heap_bytes();
+    struct binary_heap *bh = bh_create(compare_keys, NULL);
+
+    double t = now_ns();
+    for (long i = 0; i < n; ++i)
+      bh_insert(bh, &keys[i]);
+    insert += now_ns() - t;
+
+    bytes = (heap_bytes() - mem) / n;
+
+    t = now_ns();
+    while (bh_remove_max(bh) != NULL)
+      ;
+    extract += now_ns() - t;
+    bh_destroy(bh);
+
+    // The topk queries: a heap bounded to the k greatest elements.
+    bh = bh_create_topk(BENCH_TOPK, compare_keys, NULL);
+    t = now_ns();
+    for (long i = 0; i < n; ++i)
+      bh_insert(bh, &keys[i]);
+    topk += now_ns() - t;
+    bh_destroy(bh);
+  }
+
+  report("binary_heap", "insert", d, n, insert / (reps * n), bytes);
+  report("binary_heap", "remove_max", d, n, extract / (reps * n), bytes);
+  report("binary_heap", "insert_topk", d, n, topk / (reps * n), bytes);
+
+  free(keys);
+}
+
+/* ========================================================================= */
+
+int main(int argc, char *argv[])
+{
+  long max_n = argc > 1 ? atol(argv[1]) : BENCH_DEF_MAX_N;
+
+  printf("module\top\tdist\tn\tns_per_op\tbytes_per_elem\n");
+
+  bool ok = true;
+  for (long n = BENCH_MIN_N; n <= max_n; n *= 10)
+  {
+    for (int d = 0; d < NUM_DISTS; ++d)
+    {
+      bench_avl(d, n);
+      bench_hash_table(d, n);
+      bench_binary_heap(d, n);
+    }
+    ok &= check_ht_probes(n);
+  }
+
+  return ok ? 0 : 1;
+}
+/* ========================================================================= */
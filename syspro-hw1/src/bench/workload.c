@@ -0,0 +1,215 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Workload generator for replaying a command mix against diseaseMonitor:
+//
+//   workload <records> <commands> <records_file> <commands_file> [mix]
+//
+// Writes a patient records file with <records> lines, and a commands file with <commands>
+// commands, drawn with the weights of `mix`, in the order:
+//
+//   /diseaseFrequency, /topk-Diseases, /topk-Countries, /globalDiseaseStats, /insertPatientRecord, /recordPatientExit
+//
+// The commands file is then run in batch mode (-i), which reports the latency percentiles.
+// Diseases & countries are skewed (Zipf, s = 1): a few of them get most of the records & queries.
+
+#define DEF_MIX "40,10,10,5,25,10"
+
+#define NUM_DISEASES 12
+#define NUM_COUNTRIES 200
+#define NUM_DAYS (21 * 336)   // 2000 to 2020, in months of 28 days: every day drawn is valid.
+#define MAX_STAY 60           // Days a patient may stay in hospital.
+#define MAX_K 10
+
+enum cmd_type { DIS_FREQ, TOP_DIS, TOP_CTR, GLOB_DIS_STATS, INS_PAT_REC, REC_PAT_EXT, NUM_TYPES };
+
+static const char *diseases[NUM_DISEASES] =
+{
+  "COVID-2019", "H1N1", "SARS-1", "MERS", "EVD", "DENGUE",
+  "ZIKA", "CHOLERA", "MEASLES", "MALARIA", "TB", "HIV",
+};
+
+/* ========================================================================= */
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15u;
+
+// splitmix64
+static uint64_t rng(void)
+{
+  uint64_t x = (rng_state += 0x9e3779b97f4a7c15u);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31);
+}
+
+static int uniform(int n) {
+  return rng() % n;
+}
+
+// Random rank in [0, n), skewed: rank r is drawn with probability ~ 1 / (r + 1).
+static int zipf(int n)
+{
+  double u = (rng() >> 11) * (1.0 / 9007199254740992.0);
+  int r = (int)exp(u * log((double)n + 1)) - 1;
+  return r < n ? r : n - 1;
+}
+
+/* ========================================================================= */
+
+static const char *random_disease(void) {
+  return diseases[zipf(NUM_DISEASES)];
+}
+
+static void print_country(FILE *fp) {
+  fprintf(fp, "Country%03d", zipf(NUM_COUNTRIES));
+}
+
+// Print day `d` (0 is 1-1-2000) as DD-MM-YYYY.
+static void print_day(FILE *fp, int d) {
+  fprintf(fp, "%02d-%02d-%04d", d % 28 + 1, d / 28 % 12 + 1, 2000 + d / 336);
+}
+
+// Print a date range, 1 day to a few years long.
+static void print_range(FILE *fp)
+{
+  int d1 = uniform(NUM_DAYS), d2 = d1 + uniform(NUM_DAYS / 4);
+  print_day(fp, d1);
+  fputc(' ', fp);
+  print_day(fp, d2 < NUM_DAYS ? d2 : NUM_DAYS - 1);
+}
+
+// Print the fields of a record after its ID.
+static void print_record(FILE *fp)
+{
+  fprintf(fp, " F%d L%d %s ", uniform(100000), uniform(100000), random_disease());
+  print_country(fp);
+  fputc(' ', fp);
+
+  int entry = uniform(NUM_DAYS);
+  print_day(fp, entry);
+  fputc(' ', fp);
+  if (uniform(10) < 3)  // Still in hospital.
+    fputc('-', fp);
+  else
+    print_day(fp, entry + uniform(MAX_STAY));
+  fputc('\n', fp);
+}
+
+/* ========================================================================= */
+
+static void print_command(FILE *fp, enum cmd_type type, long records, long *inserted)
+{
+  bool ranged = uniform(2);
+
+  switch (type)
+  {
+    case DIS_FREQ:
+      fprintf(fp, "/diseaseFrequency %s ", random_disease());
+      print_range(fp);
+      if (ranged)
+      {
+        fputc(' ', fp);
+        print_country(fp);
+      }
+      break;
+
+    case TOP_DIS:
+      fprintf(fp, "/topk-Diseases %d ", 1 + uniform(MAX_K));
+      print_country(fp);
+      if (ranged)
+      {
+        fputc(' ', fp);
+        print_range(fp);
+      }
+      break;
+
+    case TOP_CTR:
+      fprintf(fp, "/topk-Countries %d %s", 1 + uniform(MAX_K), random_disease());
+      if (ranged)
+      {
+        fputc(' ', fp);
+        print_range(fp);
+      }
+      break;
+
+    case GLOB_DIS_STATS:
+      fprintf(fp, "/globalDiseaseStats");
+      if (ranged)
+      {
+        fputc(' ', fp);
+        print_range(fp);
+      }
+      break;
+
+    case INS_PAT_REC:
+      fprintf(fp, "/insertPatientRecord w%ld", (*inserted)++);
+      print_record(fp);
+      return;
+
+    case REC_PAT_EXT:  // Exit dates after every entry date, so every exit is recorded.
+    default:
+      fprintf(fp, "/recordPatientExit %ld ", 1 + (long)(rng() % (records ? records : 1)));
+      print_day(fp, NUM_DAYS + uniform(336));
+      break;
+  }
+  fputc('\n', fp);
+}
+
+// Parse the weights of `mix` in `weights`. Returns their sum, 0 if `mix` is invalid.
+static int parse_mix(const char *mix, int *weights)
+{
+  int sum = 0;
+  for (int t = 0; t < NUM_TYPES; ++t)
+  {
+    char *end;
+    weights[t] = strtol(mix, &end, 10);
+    if (end == mix || weights[t] < 0 || (*end != ',' && t < NUM_TYPES - 1))
+      return 0;
+    sum += weights[t];
+    mix = end + 1;
+  }
+  return sum;
+}
+
+int main(int argc, char *argv[])
+{
+  int weights[NUM_TYPES];
+  int sum = (argc == 5 || argc == 6) ? parse_mix(argc == 6 ? argv[5] : DEF_MIX, weights) : 0;
+  if (sum == 0)
+  {
+    fprintf(stderr, "Usage: %s <records> <commands> <records_file> <commands_file> [mix, default: %s]\n", argv[0], DEF_MIX);
+    return EXIT_FAILURE;
+  }
+
+  long records = atol(argv[1]), commands = atol(argv[2]);
+  FILE *rfp = fopen(argv[3], "w"), *cfp = fopen(argv[4], "w");
+  if (rfp == NULL || cfp == NULL)
+  {
+    perror("Error opening output file");
+    return EXIT_FAILURE;
+  }
+
+  for (long i = 1; i <= records; ++i)
+  {
+    fprintf(rfp, "%ld", i);
+    print_record(rfp);
+  }
+
+  long inserted = 0;
+  for (long i = 0; i < commands; ++i)
+  {
+    int w = uniform(sum), t = 0;
+    while (w >= weights[t])
+      w -= weights[t++];
+    print_command(cfp, t, records, &inserted);
+  }
+  fprintf(cfp, "/exit\n");
+
+  fclose(rfp);
+  fclose(cfp);
+  return 0;
+}
+/* ========================================================================= */
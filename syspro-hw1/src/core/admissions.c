@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "date.h"
+#include "fenwick.h"
+#include "admissions.h"
+
+/* ========================================================================= */
+
+struct disease_admissions
+{
+  struct fenwick *total;        // Admissions from every country.
+  struct fenwick **by_country;  // Indexed by country ID, NULL if no admissions from it.
+  int num_countries;            // Size of `by_country`.
+  int hospitalised;             // Patients that haven't exited yet.
+  struct ranking *countries;    // Countries ranked by admissions.
+};
+
+struct admissions
+{
+  struct disease_admissions *diseases;  // Indexed by disease ID.
+  int num_diseases;
+  struct ranking **country_diseases;    // Diseases of every country ranked by admissions, indexed by country ID.
+  int num_countries;
+  struct symbol_table *disease_names;
+  struct symbol_table *country_names;
+  struct counter *range_nodes;          // Nodes visited per range count, if not NULL.
+};
+
+/* ========================================================================= */
+
+// `diseases` & `countries` give the names of the IDs.
+struct admissions *admissions_create(struct symbol_table *diseases, struct symbol_table *countries)
+{
+  struct admissions *adm = calloc(1, sizeof(struct admissions));
+  adm->disease_names = diseases;
+  adm->country_names = countries;
+  return adm;
+}
+
+void admissions_destroy(struct admissions *adm)
+{
+  for (int i = 0; i < adm->num_diseases; ++i)
+  {
+    struct disease_admissions *dis = &adm->diseases[i];
+    if (dis->total)
+      fw_destroy(dis->total);
+
+    for (int j = 0; j < dis->num_countries; ++j)
+      if (dis->by_country[j])
+        fw_destroy(dis->by_country[j]);
+    free(dis->by_country);
+
+    if (dis->countries)
+      ranking_destroy(dis->countries);
+  }
+  free(adm->diseases);
+
+  for (int i = 0; i < adm->num_countries; ++i)
+    if (adm->country_diseases[i])
+      ranking_destroy(adm->country_diseases[i]);
+  free(adm->country_diseases);
+  free(adm);
+}
+
+/* ========================================================================= */
+
+// Grow `*array` of `*size` elements (each of `elem_size` bytes) to fit `index`.
+// New elements are zeroed.
+static void grow_to_fit(void **array, int *size, int index, size_t elem_size)
+{
+  if (index < *size)
+    return;
+
+  int new_size = *size ? *size : 8;
+  while (new_size <= index)
+    new_size *= 2;
+
+  *array = realloc(*array, new_size * elem_size);
+  memset((char *)*array + *size * elem_size, 0, (new_size - *size) * elem_size);
+  *size = new_size;
+}
+
+// Count a patient with `disease` from `country`, admitted at `entry_date`, exited at `exit_date` (if set).
+void admissions_add(struct admissions *adm, int disease, int country, struct date *entry_date, struct date *exit_date)
+{
+  grow_to_fit((void **)&adm->diseases, &adm->num_diseases, disease, sizeof(struct disease_admissions));
+  struct disease_admissions *dis = &adm->diseases[disease];
+
+  grow_to_fit((void **)&dis->by_country, &dis->num_countries, country, sizeof(struct fenwick *));
+
+  grow_to_fit((void **)&adm->country_diseases, &adm->num_countries, country, sizeof(struct ranking *));
+
+  if (dis->total == NULL)
+  {
+    dis->total = fw_create();
+    dis->countries = ranking_create();
+  }
+  if (adm->country_diseases[country] == NULL)
+    adm->country_diseases[country] = ranking_create();
+  if (dis->by_country[country] == NULL)
+    dis->by_country[country] = fw_create();
+
+  int day = date_day_index(entry_date);
+  fw_add(dis->total, day, 1);
+  fw_add(dis->by_country[country], day, 1);
+
+  if (!date_active(exit_date))
+    ++dis->hospitalised;
+
+  ranking_increment(dis->countries, country, symtab_name(adm->country_names, country));
+  ranking_increment(adm->country_diseases[country], disease, symtab_name(adm->disease_names, disease));
+}
+
+// Update the patients hospitalised, after a patient with `disease` changed their exit date from `old_exit` to `new_exit`.
+void admissions_update_exit(struct admissions *adm, int disease, struct date *old_exit, struct date *new_exit)
+{
+  // Exiting decreases the count, while clearing an exit date ("-") increases it.
+  adm->diseases[disease].hospitalised += !date_active(new_exit) - !date_active(old_exit);
+}
+
+/* ========================================================================= */
+
+// Returns the number of patients with `disease` still hospitalised, in O(1).
+int admissions_hospitalised(struct admissions *adm, int disease)
+{
+  if (disease < 0 || disease >= adm->num_diseases)  // No patients with `disease`.
+    return 0;
+  return adm->diseases[disease].hospitalised;
+}
+
+// Returns the countries of `disease` ranked by admissions, NULL if none.
+struct ranking *admissions_countries_of(struct admissions *adm, int disease)
+{
+  if (disease < 0 || disease >= adm->num_diseases)
+    return NULL;
+  return adm->diseases[disease].countries;
+}
+
+// Returns the diseases of `country` ranked by admissions, NULL if none.
+struct ranking *admissions_diseases_of(struct admissions *adm, int country)
+{
+  if (country < 0 || country >= adm->num_countries)
+    return NULL;
+  return adm->country_diseases[country];
+}
+
+// Returns the number of patients with `disease` admitted in [d1, d2].
+// If `country` != ANY_COUNTRY, only patients from `country` are counted.
+int admissions_count(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2)
+{
+  if (disease < 0 || disease >= adm->num_diseases)  // No patients with `disease`.
+    return 0;
+
+  struct disease_admissions *dis = &adm->diseases[disease];
+  struct fenwick *fw = dis->total;
+  if (country != ANY_COUNTRY)
+    fw = (country >= 0 && country < dis->num_countries) ? dis->by_country[country] : NULL;
+
+  if (fw == NULL)
+    return 0;
+
+  int nodes = 0;
+  int sum = fw_range_sum(fw, date_day_index(d1), date_day_index(d2), &nodes);
+  if (adm->range_nodes != NULL)
+    counter_add(adm->range_nodes, nodes);
+  return sum;
+}
+
+void admissions_count_nodes(struct admissions *adm, struct counter *nodes) {
+  adm->range_nodes = nodes;
+}
+
+/* ========================================================================= */
@@ -0,0 +1,47 @@
+#ifndef ADMISSIONS_H
+#define ADMISSIONS_H
+
+#include "counter.h"
+#include "date.h"
+#include "ranking.h"
+#include "symbol_table.h"
+
+// Number of patients admitted per day, for every disease and every (disease, country) pair.
+// Diseases & countries are given by their symbol IDs.
+// Each is kept in a Fenwick tree over the day numbers, so the admissions in
+// a range of dates are counted in O(log days), regardless of the patients in range.
+// The patients still hospitalised are counted per disease as well.
+// Finally, the countries of every disease & the diseases of every country
+// are kept ranked by their total admissions, for the topk queries without a range.
+struct admissions;
+
+#define ANY_COUNTRY (-1)
+
+// `diseases` & `countries` give the names of the IDs.
+struct admissions *admissions_create(struct symbol_table *diseases, struct symbol_table *countries);
+
+// Count a patient with `disease` from `country`, admitted at `entry_date`, exited at `exit_date` (if set).
+void admissions_add(struct admissions *adm, int disease, int country, struct date *entry_date, struct date *exit_date);
+
+// Update the patients hospitalised, after a patient with `disease` changed their exit date from `old_exit` to `new_exit`.
+void admissions_update_exit(struct admissions *adm, int disease, struct date *old_exit, struct date *new_exit);
+
+// Returns the number of patients with `disease` still hospitalised, in O(1).
+int admissions_hospitalised(struct admissions *adm, int disease);
+
+// Add the Fenwick tree nodes visited by every range count to `nodes` (NULL to stop).
+void admissions_count_nodes(struct admissions *adm, struct counter *nodes);
+
+// Returns the number of patients with `disease` admitted in [d1, d2].
+// If `country` != ANY_COUNTRY, only patients from `country` are counted.
+int admissions_count(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2);
+
+// Returns the countries of `disease` ranked by admissions, NULL if none.
+struct ranking *admissions_countries_of(struct admissions *adm, int disease);
+
+// Returns the diseases of `country` ranked by admissions, NULL if none.
+struct ranking *admissions_diseases_of(struct admissions *adm, int country);
+
+void admissions_destroy(struct admissions *adm);
+
+#endif
@@ -1,23 +1,17 @@
-
-#include "hash_table.h"
 #include "binary_heap.h"
-#include "avl.h"
-#include "patients.h"
+#include "symbol_table.h"
 
-int get_diseased_range(struct avl *tree, 
-                       char *field, 
-                       char *sdate1, 
-                       char *sdate2, 
-                       char *(*get_field)(struct patient_record *));
+// Number of patients that share a field (disease or country).
+struct field_count
+{
+  char *name;
+  int count;
+};
 
-void set_bh_range(struct binary_heap *bh, 
-                  struct hash_table *info,
-                  char *sdate1, 
-                  char *sdate2, 
-                  char *field, 
-                  char *(*get_field)(struct patient_record *));
+// Set up `bh` with the number of patients per disease, from `country`, in range [sdate1, sdate2].
+// Return the array that stores the elements of `bh` (NULL if none). Free it after `bh` is destroyed.
+struct field_count *set_bh_diseases(struct binary_heap *bh, char *country, char *sdate1, char *sdate2);
 
-void set_bh_no_range(struct binary_heap *bh, 
-                     struct hash_table *info, 
-                     char *field, 
-                     char *(*get_field)(struct patient_record *));
\ No newline at end of file
+// Set up `bh` with the number of patients per country, with `disease`, in range [sdate1, sdate2].
+// Return the array that stores the elements of `bh` (NULL if none). Free it after `bh` is destroyed.
+struct field_count *set_bh_countries(struct binary_heap *bh, char *disease, char *sdate1, char *sdate2);
@@ -5,157 +5,223 @@
 #include <string.h>
 
 #include "avl.h"
+#include "admissions.h"
+#include "arena.h"
 #include "date.h"
 #include "patients.h"
 #include "hash_table.h"
+#include "symbol_table.h"
 #include "global_vars.h"
 
 extern struct global_vars global;
 
 /* ========================================================================= */
 
-// Create a patient record.
-static struct patient_record *create_patient(char *rec_id, char *first, char *last, char *disease_id, char *country, char *entry_dt, char *exit_dt)
+// Create a patient record, allocated from `ar` along with its names.
+// The record isn't linked to the disease & country yet (see `add_patient_record`).
+// Only touches `ar`, so records can be created by many threads, each with its own arena.
+struct patient_record *create_patient_record(struct arena *ar, char *rec_id, char *first, char *last, char *entry_dt, char *exit_dt)
 {
-  struct patient_record *prec = malloc(sizeof(struct patient_record));
-  prec->record_id  = strdup(rec_id);
-  prec->first_name = strdup(first);
-  prec->last_name  = strdup(last);
-  prec->disease_id = strdup(disease_id);
-  prec->country = strdup(country);
-  prec->entry_date = malloc(sizeof(struct date));
-  prec->exit_date = malloc(sizeof(struct date));
-
-  convert_str_to_date(entry_dt, prec->entry_date, ENTRY);
+  struct patient_record *prec = arena_alloc(ar, sizeof(struct patient_record));
+  prec->record_id  = arena_strdup(ar, rec_id);
+  prec->first_name = arena_strdup(ar, first);
+  prec->last_name  = arena_strdup(ar, last);
+
+  convert_str_to_date(entry_dt, &prec->entry_date, ENTRY);
   if (exit_dt)
-    convert_str_to_date(exit_dt, prec->exit_date, EXIT);
+    convert_str_to_date(exit_dt, &prec->exit_date, EXIT);
   else
-    prec->exit_date->active = false;
+    date_clear(&prec->exit_date);
 
   return prec;
 }
+/* ========================================================================= */
 
-void destroy_patient_record(struct patient_record *prec)
+// Add `prec` (a patient known not to exist), with `disease_id` & `country`, in the patient ht & the admissions.
+static void link_patient_record(struct patient_record *prec, char *disease_id, char *country)
 {
-  free(prec->record_id);
-  free(prec->first_name);
-  free(prec->last_name);
-  free(prec->disease_id);
-  free(prec->country);
-  free(prec->entry_date);
-  free(prec->exit_date);
-  free(prec);
+  prec->disease = symtab_intern(global.diseases, disease_id);
+  prec->country = symtab_intern(global.countries, country);
+
+  // Add patient to the patient ht.
+  ht_insert(global.patients_ht, prec->record_id, prec);
+
+  admissions_add(global.admissions, prec->disease, prec->country, &prec->entry_date, &prec->exit_date);
 }
-/* ========================================================================= */
 
 // Insert a patient record in the data structures used by the app.
 // Return `true` if the insertion was successful.
 // Return `false` if the patient already exists.
 bool insert_patient_record(char *rec_id, char *first, char *last, char *disease_id, char *country, char *entry_dt, char *exit_dt)
 {
-  struct patient_record *prec = create_patient(rec_id, first, last, disease_id, country, entry_dt, exit_dt);
+  if (ht_search(global.patients_ht, rec_id))  // Check before allocating, arena memory isn't freed.
+    return false;
+
+  struct patient_record *prec = create_patient_record(global.records, rec_id, first, last, entry_dt, exit_dt);
+  link_patient_record(prec, disease_id, country);  // Already checked, don't search the ht twice.
+  index_patient_records(&prec, 1);
+  return true;
+}
 
+// Add `prec`, with `disease_id` & `country`, in the patient ht & the admissions.
+// The disease & country are interned, and the record keeps only their IDs.
+// Return `false` if the patient already exists.
+bool add_patient_record(struct patient_record *prec, char *disease_id, char *country)
+{
   if (ht_search(global.patients_ht, prec->record_id))
-  {
-    destroy_patient_record(prec);
     return false;
-  }
 
-  // Add patient to the patient ht.
-  ht_insert(global.patients_ht, prec->record_id, prec);
+  link_patient_record(prec, disease_id, country);
+  return true;
+}
+/* ========================================================================= */
 
-  struct avl *patient_tree = NULL;
-  // Add patient to the disease ht.
-  if ((patient_tree = ht_search(global.disease_ht, prec->disease_id)) != NULL)
-    avl_insert(patient_tree, prec);             // If the disease is already in the db.
-  else
-  {
-    patient_tree = avl_create(compare_prec_entry_dates, NULL);
-    avl_insert(patient_tree, prec);
-    ht_insert(global.disease_ht, prec->disease_id, patient_tree);  // Insert the disease in the db.
-  }
-  // Add patient to the country ht.
-  if ((patient_tree = ht_search(global.country_ht, prec->country)) != NULL)
-    avl_insert(patient_tree, prec);             // If the country is already in the db.
-  else
+// Order records by disease, then by entry date.
+static int compare_disease_entry(const void *a, const void *b)
+{
+  struct patient_record *p1 = *(struct patient_record **)a, *p2 = *(struct patient_record **)b;
+  if (p1->disease != p2->disease)
+    return p1->disease < p2->disease ? -1 : 1;
+  return compare_prec_entry_dates(p1, p2);
+}
+
+// Order records by country, then by entry date.
+static int compare_country_entry(const void *a, const void *b)
+{
+  struct patient_record *p1 = *(struct patient_record **)a, *p2 = *(struct patient_record **)b;
+  if (p1->country != p2->country)
+    return p1->country < p2->country ? -1 : 1;
+  return compare_prec_entry_dates(p1, p2);
+}
+
+// Sort `precs` by `compare` (unless NULL, if already sorted), then add every run of records
+// that have `get_field` in common to the tree of `info` with that key (an ID of `fields`), in bulk.
+static void index_by_field(struct patient_record **precs, int n, int (*compare)(const void *, const void *),
+                           int (*get_field)(struct patient_record *), struct hash_table *info, struct symbol_table *fields)
+{
+  if (compare != NULL)
+    qsort(precs, n, sizeof(struct patient_record *), compare);
+
+  for (int beg = 0, end; beg < n; beg = end)
   {
-    patient_tree = avl_create(compare_prec_entry_dates, NULL);
-    avl_insert(patient_tree, prec);
-    ht_insert(global.country_ht, prec->country, patient_tree);  // Insert the country in the db.
+    int field = get_field(precs[beg]);
+    for (end = beg + 1; end < n && get_field(precs[end]) == field; ++end)
+      ;
+
+    // Keys of the disease & country ht are the interned names, which outlive the hts.
+    char *key = symtab_name(fields, field);
+
+    struct avl *patient_tree = ht_search(info, key);
+    if (patient_tree == NULL)  // 1st patient with `field`.
+    {
+      patient_tree = avl_create(compare_prec_entry_dates, NULL);
+      ht_insert(info, key, patient_tree);
+    }
+    avl_build_sorted(patient_tree, (void **)&precs[beg], end - beg);
   }
+}
 
-  return true;
+// Add `n` records, already added by `add_patient_record`, to the disease & country trees.
+// The records are grouped & sorted by entry date, so each tree takes a sorted batch,
+// that it merges in linear time if large enough. `precs` is reordered.
+void index_patient_records(struct patient_record **precs, int n)
+{
+  index_by_field(precs, n, compare_disease_entry, patient_get_disease, global.disease_ht, global.diseases);
+  index_by_field(precs, n, compare_country_entry, patient_get_country, global.country_ht, global.countries);
+}
+
+// Same as `index_patient_records`, for records already ordered by disease (`by_disease`)
+// and by country (`by_country`), then by entry date. No sorting takes place.
+void index_sorted_patient_records(struct patient_record **by_disease, struct patient_record **by_country, int n)
+{
+  index_by_field(by_disease, n, NULL, patient_get_disease, global.disease_ht, global.diseases);
+  index_by_field(by_country, n, NULL, patient_get_country, global.country_ht, global.countries);
 }
 /* ========================================================================= */
 
-// Update a patient's exit date. Print a msg on error.
-void record_patient_exit(char *rec_id, char *exit_dt)
+// Set the exit date of `rec_id` to `exit_dt`, without printing anything.
+// The exit date isn't changed if it would precede the entry date.
+enum exit_result set_patient_exit(char *rec_id, char *exit_dt)
 {
   struct patient_record *prec = ht_search(global.patients_ht, rec_id);
-
   if (prec == NULL)
-    printf("Not found\n");
-  else
+    return EXIT_NOT_FOUND;
+
+  struct date old = prec->exit_date;
+  convert_str_to_date(exit_dt, &prec->exit_date, EXIT);
+
+  if (compare_dates(&prec->entry_date, &prec->exit_date) > 0)
+  {
+    prec->exit_date = old;  // Restore the old exit date.
+    return EXIT_BEFORE_ENTRY;
+  }
+
+  admissions_update_exit(global.admissions, prec->disease, &old, &prec->exit_date);
+  return EXIT_UPDATED;
+}
+
+// Returns true if the exit date was updated.
+bool record_patient_exit(FILE *out, char *rec_id, char *exit_dt)
+{
+  switch (set_patient_exit(rec_id, exit_dt))
   {
-    struct date old = *(prec->exit_date);
-    convert_str_to_date(exit_dt, prec->exit_date, EXIT);
+    case EXIT_NOT_FOUND:
+      fprintf(out, "Not found\n");
+      return false;
 
-    if (compare_dates(prec->entry_date, prec->exit_date) > 0)
+    case EXIT_BEFORE_ENTRY:
     {
-      printf("record_patient_exit: Exit date given is lesser than current entry date.\n");
-      printf("Entry date: \n");
-      print_date(prec->entry_date);
-      printf("Exit date given: \n");
-      print_date(prec->exit_date);
-      *(prec->exit_date) = old;  // Restore the old exit date.
+      struct patient_record *prec = ht_search(global.patients_ht, rec_id);
+      struct date given;
+      convert_str_to_date(exit_dt, &given, EXIT);
+
+      fprintf(out, "record_patient_exit: Exit date given is lesser than current entry date.\n");
+      fprintf(out, "Entry date: \n");
+      print_date(out, &prec->entry_date);
+      fprintf(out, "Exit date given: \n");
+      print_date(out, &given);
+      return false;
     }
-    else
-      printf("Record updated\n");
+
+    case EXIT_UPDATED:
+    default:
+      fprintf(out, "Record updated\n");
+      return true;
   }
 }
 
 /* ========================================================================= */
 
-// Prints the number of patients still hospitalised for `disease` if given,
-// else for every disease.
-void num_current_patients(char *disease)
+// Prints to `out` the number of patients still hospitalised for `disease` if given,
+// else for every disease. The counts are kept up to date on insertion & exit.
+void num_current_patients(FILE *out, char *disease)
 {
   if (disease != NULL)
   {
-    struct avl *tree = ht_search(global.disease_ht, disease); // Get the disease avl.
-    int sum = 0;
-    for (struct avl_node *node = avl_first(tree); node != NULL; node = avl_next(tree, node))
-    {
-      struct patient_record *prec = avl_node_value(node);
-      if (prec->exit_date->active == false)  // Patient still hospitalised.
-        ++sum;
-    }
-    printf("%s %d\n", disease, sum);
+    int sum = admissions_hospitalised(global.admissions, symtab_lookup(global.diseases, disease));
+    fprintf(out, "%s %d\n", disease, sum);
   }
-  else  // Traverse every disease avl in the ht.
+  else  // Traverse every disease in the ht.
   {
+    struct ht_iter it;
+    ht_iter_init(&it, global.disease_ht);
+
     struct bucket_entry *entry;
-    while ((entry = ht_traverse(global.disease_ht)) != NULL)
+    while ((entry = ht_iter_next(&it)) != NULL)
     {
-      int sum = 0;
-      for (struct avl_node *node = avl_first(entry->data); node != NULL; node = avl_next(entry->data, node))
-      {
-        struct patient_record *prec = avl_node_value(node);
-        if (prec->exit_date->active == false)  // Patient still hospitalised.
-          ++sum;
-      }
-      printf("%s %d\n", entry->key, sum);
+      int sum = admissions_hospitalised(global.admissions, symtab_lookup(global.diseases, entry->key));
+      fprintf(out, "%s %d\n", entry->key, sum);
     }
   }
 }
 
 /* ========================================================================= */
 
-char *patient_get_country(struct patient_record *prec) {
+int patient_get_country(struct patient_record *prec) {
   return prec->country;
 }
 
-char *patient_get_disease_id(struct patient_record *prec) {
-  return prec->disease_id;
+int patient_get_disease(struct patient_record *prec) {
+  return prec->disease;
 }
 /* ========================================================================= */
\ No newline at end of file
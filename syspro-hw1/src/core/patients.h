@@ -1,28 +1,55 @@
 #ifndef PATIENTS_H
 #define PATIENTS_H
 
+#include <stdio.h>  // FILE
 #include <stdbool.h>
 
+#include "arena.h"
+#include "date.h"
+
+// Records, along with their names, are allocated from `global.records`.
+// The disease & country are stored as symbol IDs, in `global.diseases` & `global.countries`.
 struct patient_record
 {
+  int disease;
+  int country;
   char *record_id;
   char *first_name;
   char *last_name;
-  char *disease_id;
-  char *country;
-  struct date *entry_date;
-  struct date *exit_date;
+  struct date entry_date;
+  struct date exit_date;
 };
 
 // Returns true on success, false on failure.
 bool insert_patient_record(char *rec_id, char *first, char *last, char *disease_id, char *country, char *entry_dt, char *exit_dt);
 
-void record_patient_exit(char *rec_id, char *exit_dt);
-void num_current_patients(char *disease);
+// Create a record in `ar`, to be added later with `add_patient_record`. Thread-safe, for distinct arenas.
+struct patient_record *create_patient_record(struct arena *ar, char *rec_id, char *first, char *last, char *entry_dt, char *exit_dt);
+
+// Adds the record to the patient ht & the admissions. Returns false if the patient already exists.
+bool add_patient_record(struct patient_record *prec, char *disease_id, char *country);
+
+// Adds `n` records, given to `add_patient_record`, to the disease & country trees, in bulk. Reorders `precs`.
+void index_patient_records(struct patient_record **precs, int n);
+
+// Same, for records already ordered by disease & by country, then by entry date.
+void index_sorted_patient_records(struct patient_record **by_disease, struct patient_record **by_country, int n);
+
+enum exit_result
+{
+  EXIT_UPDATED,
+  EXIT_NOT_FOUND,
+  EXIT_BEFORE_ENTRY,   // The exit date given precedes the entry date, the record is left as is.
+};
+
+// Sets the exit date of a record, without printing anything (e.g. when replaying the log).
+enum exit_result set_patient_exit(char *rec_id, char *exit_dt);
 
-void destroy_patient_record(struct patient_record *prec);
+// Same, printing the outcome to `out`. Returns true if the exit date was updated.
+bool record_patient_exit(FILE *out, char *rec_id, char *exit_dt);
+void num_current_patients(FILE *out, char *disease);
 
-char *patient_get_country(struct patient_record *prec);
-char *patient_get_disease_id(struct patient_record *prec);
+int patient_get_country(struct patient_record *prec);
+int patient_get_disease(struct patient_record *prec);
 
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "avl.h"
+#include "admissions.h"
 #include "date.h"
 #include "stats.h"
 #include "helpers.h"
@@ -17,99 +18,133 @@ extern struct global_vars global;
 /* ========================================================================= */
 
 // Prints the number of patients for every disease (in range [sdate1, sdate2], if specified).
-void global_disease_stats(char *sdate1, char *sdate2)
+void global_disease_stats(FILE *out, char *sdate1, char *sdate2)
 {
-  if (sdate1 == NULL) // No range.
+  struct date d1, d2;
+  if (sdate1 != NULL)
   {
-    struct bucket_entry *entry;
-    while ((entry = ht_traverse(global.disease_ht)) != NULL)
-      printf("%s %d\n", entry->key, avl_size(entry->data));
+    convert_str_to_date(sdate1, &d1, DUMMY_BEGIN);
+    convert_str_to_date(sdate2, &d2, DUMMY_END);
   }
-  else
+
+  struct ht_iter it;                   // Traverse the disease ht to extract stats.
+  ht_iter_init(&it, global.disease_ht);
+
+  struct bucket_entry *entry;
+  while ((entry = ht_iter_next(&it)) != NULL)
   {
-    struct bucket_entry *entry;                    // Traverse the disease ht to extract stats.
-    while ((entry = ht_traverse(global.disease_ht)) != NULL)
-      printf("%s %d\n", entry->key, get_diseased_range(entry->data, sdate1, sdate2, NULL, NULL));
+    if (sdate1 == NULL) // No range.
+      fprintf(out, "%s %d\n", entry->key, avl_size(entry->data));
+    else
+    {
+      int disease = symtab_lookup(global.diseases, entry->key);
+      fprintf(out, "%s %d\n", entry->key, admissions_count(global.admissions, disease, ANY_COUNTRY, &d1, &d2));
+    }
   }
 }
 /* ========================================================================= */
 
 // Prints the number of patients for `disease` in range [sdate1, sdate2].
 // If `country` is specified, patients originate from `country`.
-void disease_frequency(char *disease, char *sdate1, char *sdate2, char *country)
+void disease_frequency(FILE *out, char *disease, char *sdate1, char *sdate2, char *country)
 {
-  struct avl *patient_tree = ht_search(global.disease_ht, disease);
-  printf("%s %d\n", disease, get_diseased_range(patient_tree, sdate1, sdate2, country, patient_get_country));
-}
+  struct date d1, d2;
+  convert_str_to_date(sdate1, &d1, DUMMY_BEGIN);
+  convert_str_to_date(sdate2, &d2, DUMMY_END);
 
-/* ========================================================================= */
+  int country_id = ANY_COUNTRY;
+  if (country != NULL && (country_id = symtab_lookup(global.countries, country)) < 0)
+  {
+    fprintf(out, "%s 0\n", disease);  // No patients from `country`.
+    return;
+  }
 
-static void free_ints(void *val)
-{
-  struct bucket_entry *entry = val;
-  free(entry->data);  // int *
-  free(entry);
+  int sum = admissions_count(global.admissions, symtab_lookup(global.diseases, disease), country_id, &d1, &d2);
+  fprintf(out, "%s %d\n", disease, sum);
 }
 
+/* ========================================================================= */
+
 static int compare_pairs(void *a, void *b)
 {
-  struct bucket_entry *a1 = a, *b1 = b;
-  int res = *(int *)(a1->data) - *(int *)(b1->data);
+  struct field_count *a1 = a, *b1 = b;
+  int res = a1->count - b1->count;
   if (res == 0)
-    return -1 * strcmp(a1->key, b1->key);
+    return -1 * strcmp(a1->name, b1->name);
   return res;
 }
 
-// Extract, print and destroy the k first elements of `bh`.
-static void extract_results(struct binary_heap *bh, int k)
+// Extract and print to `out` the k first elements of `bh`, and record its sizes in the stats.
+static void extract_results(FILE *out, struct binary_heap *bh, int k)
 {
+  counter_add(&global.stats.heap_inserted, bh_inserted(bh));
+  counter_add(&global.stats.heap_peak, bh_peak(bh));
+
   for (int i = 1; i <= k; ++i)
   {
-    struct bucket_entry *p = bh_remove_max(bh); // Get the entry with the most patients.
+    struct field_count *p = bh_remove_max(bh); // Get the entry with the most patients.
     if (p != NULL)
-    {
-      printf("%s %d\n", p->key, *(int *)(p->data));
-      free_ints(p);   // Destroy the element extracted.
-    }
+      fprintf(out, "%s %d\n", p->name, p->count);
     else
       return; // No more elements to extract, binary heap is empty.
   }
 }
 /* ========================================================================= */
 
+// Print to `out` the `k` first items of `r` (if any).
+static void print_ranking(FILE *out, struct ranking *r, int k)
+{
+  for (int i = 0; r != NULL && i < k && i < ranking_size(r); ++i)
+  {
+    struct rank_entry *entry = ranking_get(r, i);
+    fprintf(out, "%s %d\n", entry->name, entry->count);
+  }
+}
+
+/* ========================================================================= */
+
 // Prints the `k` most infective diseases in `country` 
 // (in range [sdate1, sdate2] if specified) 
-void topk_diseases(int k, char *country, char *sdate1, char *sdate2)
+void topk_diseases(FILE *out, int k, char *country, char *sdate1, char *sdate2)
 {
-  struct binary_heap *bh = bh_create(compare_pairs, free_ints);
-  
-  // Set up the bin heap, based on the `country_ht` and comparing patients using `disease_id`
-  if (sdate1 == NULL)
-    set_bh_no_range(bh, global.country_ht, country, patient_get_disease_id);
-  else
-    set_bh_range(bh, global.country_ht, sdate1, sdate2, country, patient_get_disease_id);
+  if (sdate1 == NULL)  // No range: read the ranking kept up to date on insertion, in O(k).
+  {
+    print_ranking(out, admissions_diseases_of(global.admissions, symtab_lookup(global.countries, country)), k);
+    return;
+  }
+
+  // Keep only the top `k` entries; they are stored in (and freed with) the `counts` array.
+  struct binary_heap *bh = bh_create_topk(k, compare_pairs, NULL);
+
+  // Set up the bin heap with the admissions of every disease in `country`.
+  struct field_count *counts = set_bh_diseases(bh, country, sdate1, sdate2);
 
-  extract_results(bh, k);
+  extract_results(out, bh, k);
 
   bh_destroy(bh);   // Destroy the binary heap.
+  free(counts);
 }
 
 /* ========================================================================= */
 
 // Prints the `k` most infected countries from `disease` 
 // (in range [sdate1, sdate2] if specified) 
-void topk_countries(int k, char *disease, char *sdate1, char *sdate2)
+void topk_countries(FILE *out, int k, char *disease, char *sdate1, char *sdate2)
 {
-  struct binary_heap *bh = bh_create(compare_pairs, free_ints); // Create the bin heap
+  if (sdate1 == NULL)  // No range: read the ranking kept up to date on insertion, in O(k).
+  {
+    print_ranking(out, admissions_countries_of(global.admissions, symtab_lookup(global.diseases, disease)), k);
+    return;
+  }
+
+  struct binary_heap *bh = bh_create_topk(k, compare_pairs, NULL); // Create the bin heap
 
-  // Set up the bin heap, based on the `disease_ht` and comparing patients using `country`
-  if (sdate1 == NULL)
-    set_bh_no_range(bh, global.disease_ht, disease, patient_get_country);
-  else
-    set_bh_range(bh, global.disease_ht, sdate1, sdate2, disease, patient_get_country);
+  // Set up the bin heap with the admissions of `disease` in every country.
+  struct field_count *counts = set_bh_countries(bh, disease, sdate1, sdate2);
 
-  extract_results(bh, k);
+  extract_results(out, bh, k);
 
   bh_destroy(bh);
+  free(counts);
 }
 /* ========================================================================= */
\ No newline at end of file
@@ -1,9 +1,14 @@
 
 
-void global_disease_stats(char *sdate1, char *sdate2);
+#include <stdio.h>  // FILE
 
-void disease_frequency(char *disease, char *sdate1, char *sdate2, char *country);
+// Every query prints its results to `out`. They only read the structures,
+// so several queries may run in parallel, as long as no record is inserted meanwhile.
 
-void topk_diseases(int k, char *country, char *sdate1, char *sdate2);
+void global_disease_stats(FILE *out, char *sdate1, char *sdate2);
 
-void topk_countries(int k, char *disease, char *sdate1, char *sdate2);
\ No newline at end of file
+void disease_frequency(FILE *out, char *disease, char *sdate1, char *sdate2, char *country);
+
+void topk_diseases(FILE *out, int k, char *country, char *sdate1, char *sdate2);
+
+void topk_countries(FILE *out, int k, char *disease, char *sdate1, char *sdate2);
\ No newline at end of file
@@ -2,21 +2,39 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include "loader.h"
+#include "snapshot.h"
+#include "wal.h"
 #include "utilities.h"
 #include "interface.h"
 
 
 int main(int argc, const char *argv[])
 {
-  FILE *fp;
-  int dis_ht_entries, ctry_ht_entries, bucket_size;
+  FILE *fp, *commands;
+  const char *snapshot, *wal;
+  int dis_ht_entries, ctry_ht_entries, bucket_size, threads;
 
-  handle_cmd_line_args(argc, argv, &fp, &dis_ht_entries, &ctry_ht_entries, &bucket_size);
+  handle_cmd_line_args(argc, argv, &fp, &snapshot, &wal, &commands, &dis_ht_entries, &ctry_ht_entries, &bucket_size, &threads);
 
-  setup_structures(dis_ht_entries, ctry_ht_entries, bucket_size);
+  if (commands != NULL)  // Batch mode: stdout is fully buffered, set before anything is printed.
+    setvbuf(stdout, NULL, _IOFBF, BATCH_OUTPUT_BUFFER);
 
-  if (parse_file(fp) == true)
-    interface();     // If the file given doesn't have duplicate patient records, proceed.
+  setup_structures(dis_ht_entries, ctry_ht_entries, bucket_size, threads);
+
+  bool loaded = snapshot ? load_snapshot(snapshot) : load_patient_records(fp);
+  if (loaded == true && wal != NULL)
+    loaded = wal_open(wal);  // Replay the commands logged since the file (or snapshot) was made.
+
+  if (loaded == true)  // If the file (or snapshot) given doesn't have duplicate patient records, proceed.
+  {
+    if (commands != NULL)
+      batch(commands);
+    else
+      interface();
+  }
+
+  wal_close();
 
   cleanup_structures();
 
@@ -1,29 +1,52 @@
+#include <stdbool.h>
+#include <stdlib.h> // malloc, realloc, free
 
-#include <stdlib.h> // calloc, free
+#include "binary_heap.h"
 
-struct bh_node
-{
-  struct bh_node *left;
-  struct bh_node *right;
-  struct bh_node *parent;
-  struct bh_node *prev;   // Immediate previous node via level order.
-  void *data;
-};
+// The heap is stored in a single array, in level order:
+// the children of position `i` are at `2i + 1` and `2i + 2`.
+//
+// A *bounded* heap (bh_create_topk) keeps only the `k` greatest elements it is given.
+// It is ordered as a min-heap, so the root is the least element kept, the one a greater
+// element replaces. On the first removal, the array is sorted in descending order and
+// the elements are handed out from its front.
 
 struct binary_heap
 {
   int size;
-  struct bh_node *root;
-  struct bh_node *last;   // Last node of the binary heap.
+  int capacity;
+  void **data;
+  int limit;      // Max number of elements kept, 0 if unbounded.
+  int first;      // Index of the next element to remove, once `sorted`.
+  bool sorted;    // Bounded heap only: the array is sorted in descending order.
+  int inserted;   // Elements given to the heap, kept or not.
+  int peak;       // Max size reached.
   int (*compare_func)(void *a, void *b);
   void (*destroy_func)(void *data);
 };
 
+#define BH_INIT_CAPACITY 16
+
 /* ========================================================================= */
 
 struct binary_heap *bh_create(int (*compare_func)(void *a, void *b), void (*destroy_func)(void *data))
 {
   struct binary_heap *heap = calloc(1, sizeof(struct binary_heap));
+  heap->capacity = BH_INIT_CAPACITY;
+  heap->data = malloc(heap->capacity * sizeof(void *));
+  heap->compare_func = compare_func;
+  heap->destroy_func = destroy_func;
+  return heap;
+}
+
+// Create a heap that keeps only the `k` greatest elements inserted.
+// Elements that don't make it to the top `k` are destroyed on insertion.
+struct binary_heap *bh_create_topk(int k, int (*compare_func)(void *a, void *b), void (*destroy_func)(void *data))
+{
+  struct binary_heap *heap = calloc(1, sizeof(struct binary_heap));
+  heap->limit = k > 0 ? k : 1;
+  heap->capacity = heap->limit;
+  heap->data = malloc(heap->capacity * sizeof(void *));
   heap->compare_func = compare_func;
   heap->destroy_func = destroy_func;
   return heap;
@@ -32,178 +55,163 @@ struct binary_heap *bh_create(int (*compare_func)(void *a, void *b), void (*dest
 /* ========================================================================= */
 
 int bh_size(struct binary_heap *bh) {
-  return bh->size;
+  return bh->size - bh->first;
 }
 
-/* ========================================================================= */
-// Swaps *only* the data member of 2 nodes.
-static void swap(struct bh_node *a, struct bh_node *b)
-{
-  void *tmp = a->data;
-  a->data = b->data;
-  b->data = tmp;
+int bh_inserted(struct binary_heap *bh) {
+  return bh->inserted;
 }
 
-/* ========================================================================= */
-
-enum child_t { LEFT, RIGHT };
-
-void bh_insert(struct binary_heap *bh, void *data);
-static void heapify_up(struct binary_heap *bh, struct bh_node *node);
-static void insert_last(struct binary_heap *bh, void *data);
-static void insert_root(struct binary_heap *bh, void *data);
-static void rec_insert(struct binary_heap *bh, struct bh_node *node, struct bh_node *last, void *data);
-static void insert_leftmost(struct binary_heap *bh, struct bh_node *node, void *data);
-static void insert_child(enum child_t type, struct binary_heap *bh, struct bh_node *node, void *data);
+int bh_peak(struct binary_heap *bh) {
+  return bh->peak;
+}
 
+/* ========================================================================= */
 
-void bh_insert(struct binary_heap *bh, void *data)
+static void swap(struct binary_heap *bh, int i, int j)
 {
-  insert_last(bh, data);
-  heapify_up(bh, bh->last);
+  void *tmp = bh->data[i];
+  bh->data[i] = bh->data[j];
+  bh->data[j] = tmp;
 }
 
-// Heapify the tree starting from `node` and going updwards to the root.
-static void heapify_up(struct binary_heap *bh, struct bh_node *node)
+// True if the element at `i` belongs above the element at `j`.
+// Max-heap order for unbounded heaps, min-heap order for bounded ones.
+static bool precedes(struct binary_heap *bh, int i, int j)
 {
-  if (node == bh->root)
-    return;
+  int res = bh->compare_func(bh->data[i], bh->data[j]);
+  return bh->limit ? res < 0 : res > 0;
+}
 
-  if (bh->compare_func(node->parent->data, node->data) < 0)
+// Heapify the array starting from `pos` and going upwards to the root.
+static void heapify_up(struct binary_heap *bh, int pos)
+{
+  while (pos > 0)
   {
-    swap(node->parent, node);  // Child is greater than the Parent so swap.
-    heapify_up(bh, node->parent);
+    int parent = (pos - 1) / 2;
+    if (!precedes(bh, pos, parent))
+      return;
+
+    swap(bh, pos, parent);  // Child belongs above the parent, so swap.
+    pos = parent;
   }
 }
 
-static void insert_last(struct binary_heap *bh, void *data)
+// Heapify the first `size` elements of the array, starting from `pos` going downwards.
+static void heapify_down(struct binary_heap *bh, int pos, int size)
 {
-  if (bh->root == NULL)
-    insert_root(bh, data);
-  else
-    rec_insert(bh, bh->last->parent, bh->last, data);
-}
+  while (true)
+  {
+    int child = 2 * pos + 1;
+    if (child >= size)  // `pos` is a leaf.
+      return;
 
-static void insert_root(struct binary_heap *bh, void *data)
-{
-  bh->root = calloc(1, sizeof(struct bh_node));
-  bh->root->data = data;
-  bh->last = bh->root;
-  ++bh->size;
-}
+    if (child + 1 < size && precedes(bh, child + 1, child))
+      ++child;      // Pick the child that belongs higher.
 
-static void rec_insert(struct binary_heap *bh, struct bh_node *node, struct bh_node *last, void *data)
-{
-  if (node == NULL)   // We reached the root, so every level is full.
-    insert_leftmost(bh, bh->root, data);
-  else if (node->right == last)   // Last node is the right child of `node`, so try to insert at the parent of `node`.
-    rec_insert(bh, node->parent, node, data);
-  else if (node->right == NULL)   // Empty right node, insert there.
-    insert_child(RIGHT, bh, node, data);
-  else
-    insert_leftmost(bh, node->right, data);   // Full left subtree.
-}
+    if (!precedes(bh, child, pos))
+      return;
 
-// Insert at the leftmost leaf of tree with root `node`.
-static void insert_leftmost(struct binary_heap *bh, struct bh_node *node, void *data)
-{
-  if (node->left == NULL)
-    insert_child(LEFT, bh, node, data);
-  else
-    insert_leftmost(bh, node->left, data);
+    swap(bh, pos, child);
+    pos = child;
+  }
 }
 
-// Insert a node as a child of `node`.
-static void insert_child(enum child_t type, struct binary_heap *bh, struct bh_node *node, void *data)
+// Re-arrange the remaining elements of a sorted bounded heap back into a heap.
+static void unsort(struct binary_heap *bh)
 {
-  struct bh_node **child = &node->right;
-  if (type == LEFT)
-    child = &node->left;
-
-  *child = calloc(1, sizeof(struct bh_node));
-  (*child)->parent = node;
-  (*child)->prev = bh->last;  // Keep the previous node via level order.
-  (*child)->data = data;
-  bh->last = *child;  // Update last node of the heap.
-  ++bh->size;
+  int n = bh->size - bh->first;
+  for (int i = 0; i < n; ++i)
+    bh->data[i] = bh->data[bh->first + i];
+
+  bh->size = n;
+  bh->first = 0;
+  bh->sorted = false;
+
+  for (int i = n / 2 - 1; i >= 0; --i)
+    heapify_down(bh, i, n);
 }
 
 /* ========================================================================= */
 
-static void heapify_down(struct binary_heap *bh, struct bh_node *node);
-static void remove_leaf(struct binary_heap *bh, struct bh_node *node);
-
-void *bh_remove_max(struct binary_heap *bh)
+void bh_insert(struct binary_heap *bh, void *data)
 {
-  if (bh->size == 0)
-    return NULL;
+  if (bh->sorted)
+    unsort(bh);
 
-  void *max = bh->root->data;
+  ++bh->inserted;
+  if (bh->limit && bh->size == bh->limit)  // Bounded heap is full.
+  {
+    if (bh->compare_func(data, bh->data[0]) <= 0)  // Not greater than the least element kept.
+    {
+      if (bh->destroy_func)
+        bh->destroy_func(data);
+      return;
+    }
+
+    if (bh->destroy_func)
+      bh->destroy_func(bh->data[0]);  // Evict the least element kept.
+    bh->data[0] = data;
+    heapify_down(bh, 0, bh->size);
+    return;
+  }
 
-  swap(bh->root, bh->last);
-  remove_leaf(bh, bh->last);
+  if (bh->size == bh->capacity)
+  {
+    bh->capacity *= 2;
+    bh->data = realloc(bh->data, bh->capacity * sizeof(void *));
+  }
 
-  heapify_down(bh, bh->root);
+  bh->data[bh->size] = data;
+  heapify_up(bh, bh->size++);
 
-  return max;
+  if (bh->size > bh->peak)
+    bh->peak = bh->size;
 }
 
-// Heapify the tree, starting from root `node` going downwards until we reach a leaf.
-static void heapify_down(struct binary_heap *bh, struct bh_node *node)
-{
-  if (node == NULL || node->left == NULL) // node is leaf.
-    return;
-
-  struct bh_node *max_child = node->left;
-  if (node->right && bh->compare_func(node->left->data, node->right->data) < 0)
-    max_child = node->right;
+/* ========================================================================= */
 
-  if (bh->compare_func(node->data, max_child->data) < 0)
+// Sort a bounded (min-)heap in descending order, by moving its root to the end, repeatedly.
+static void sort_descending(struct binary_heap *bh)
+{
+  for (int last = bh->size - 1; last > 0; --last)
   {
-    swap(node, max_child);  // Child is greater than the node, so swap.
-    heapify_down(bh, max_child);
+    swap(bh, 0, last);
+    heapify_down(bh, 0, last);
   }
+  bh->sorted = true;
 }
 
-static void remove_leaf(struct binary_heap *bh, struct bh_node *node)
+void *bh_remove_max(struct binary_heap *bh)
 {
-  bh->last = node->prev;  // Update last as the previous node in level order.
-
-  struct bh_node *parent = node->parent;
-  if (parent) // If not root.
-  {
-    if (parent->left == node) // Update parent link.
-      parent->left = NULL;
-    else
-      parent->right = NULL;
+  if (bh_size(bh) == 0)
+    return NULL;
 
-    free(node);
-  }
-  else
+  if (bh->limit)  // Bounded heap: hand out elements in descending order.
   {
-    free(bh->root);
-    bh->root = NULL;
+    if (!bh->sorted)
+      sort_descending(bh);
+    return bh->data[bh->first++];
   }
-  --bh->size;
-}
 
-/* ========================================================================= */
-// Recursively destroy a subtree with root `node`
-static void node_destroy(struct bh_node *node, void (*destroy_func)(void *data))
-{
-  if (node == NULL)
-    return;
+  void *max = bh->data[0];
+
+  bh->data[0] = bh->data[--bh->size];  // Move the last element to the root.
+  heapify_down(bh, 0, bh->size);
 
-  node_destroy(node->left, destroy_func);
-  node_destroy(node->right, destroy_func);
-  destroy_func(node->data);
-  free(node);
+  return max;
 }
 
+/* ========================================================================= */
+
 void bh_destroy(struct binary_heap *bh)
 {
-  node_destroy(bh->root, bh->destroy_func);
+  if (bh->destroy_func)
+    for (int i = bh->first; i < bh->size; ++i)
+      bh->destroy_func(bh->data[i]);
+
+  free(bh->data);
   free(bh);
 }
 
-/* ========================================================================= */
\ No newline at end of file
+/* ========================================================================= */
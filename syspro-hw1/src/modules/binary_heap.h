@@ -1,13 +1,27 @@
+#ifndef BINARY_HEAP_H
+#define BINARY_HEAP_H
 
 struct binary_heap;
 
 
 struct binary_heap *bh_create(int (*compare_func)(void *a, void *b), void (*destroy_func)(void *data));
 
+// Create a heap that keeps only the `k` greatest elements inserted, in O(logk) per insertion.
+// Elements that don't make it to the top `k` are destroyed on insertion.
+struct binary_heap *bh_create_topk(int k, int (*compare_func)(void *a, void *b), void (*destroy_func)(void *data));
+
 int bh_size(struct binary_heap *bh);
 
+// Elements given to the heap, kept or not.
+int bh_inserted(struct binary_heap *bh);
+
+// Elements kept by the heap at once, at most.
+int bh_peak(struct binary_heap *bh);
+
 void bh_insert(struct binary_heap *bh, void *data);
 
 void *bh_remove_max(struct binary_heap *bh);
 
 void bh_destroy(struct binary_heap *bh);
+
+#endif
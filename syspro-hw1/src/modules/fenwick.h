@@ -0,0 +1,20 @@
+#ifndef FENWICK_H
+#define FENWICK_H
+
+// Fenwick (binary indexed) tree of counters, over integer positions.
+// Supports adding to a position & summing a range of positions, both in O(logn),
+// where n is the extent of the positions used so far. Positions may be negative.
+struct fenwick;
+
+struct fenwick *fw_create(void);
+
+// Add `delta` to the counter at `pos`.
+void fw_add(struct fenwick *fw, int pos, int delta);
+
+// Returns the sum of the counters at positions [lo, hi].
+// The tree nodes visited are added to `*nodes`, if not NULL.
+int fw_range_sum(struct fenwick *fw, int lo, int hi, int *nodes);
+
+void fw_destroy(struct fenwick *fw);
+
+#endif
@@ -1,6 +1,6 @@
-
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -8,30 +8,74 @@
 
 /* ========================================================================= */
 
-struct hash_table
+// Open addressing with linear probing and Robin Hood displacement.
+// Every slot keeps the entry *inline*, next to the cached hash of its key,
+// so a lookup scans one flat array and calls `strcmp` only on a hash match.
+//
+// When the load factor exceeds 3/4, the table allocates a slot array of double
+// capacity and migrates the old slots *incrementally*: every insertion moves
+// a few of them, so no single operation pays for a full rehash.
+// Until the migration finishes, lookups that miss the new array also probe the old one.
+// Searches and iterations never modify the table, so they can run concurrently with each other,
+// but not with an insertion, which moves entries between slots and frees the old array once migrated.
+// Callers that insert while other threads search must hold a lock (e.g. a rwlock, written on insertion).
+
+struct ht_slot
 {
-  int size;   // Number of total items stored in the HT.
-  int num_of_entries;   // Number of entries each bucket can store.   
-  int num_of_buckets;
-  struct bucket **buckets;    // Array of (ptrs to) buckets.
-  void (*destroy_func)(void *data);
+  unsigned int hash;          // Cached hash of the key. 0 marks an empty slot.
+  struct bucket_entry entry;  // Key & data stored in the slot.
 };
 
-struct bucket
+struct hash_table
 {
-  struct bucket_entry **entries; // Array of (ptrs to) entries.
-  struct bucket *next;  // Pointer to the next bucket, implements list/seperate chaining.
+  int size;       // Number of total items stored in the HT.
+  int capacity;   // Number of slots, always a power of 2.
+  struct ht_slot *slots;    // Flat array of slots.
+  struct ht_slot *old_slots;  // Slots being migrated to `slots`, NULL if not resizing.
+  int old_capacity;
+  int migrated;       // Slots of `old_slots` with index < `migrated` have been moved.
+  void (*probe_hook)(void *arg, int probes);  // Called on every search, if not NULL.
+  void *probe_arg;
+  void (*destroy_func)(void *data);
 };
 
+// Start growing the table when it is more than 3/4 full, to keep the probe sequences short.
+#define HT_MAX_LOAD(capacity) ((capacity) - (capacity) / 4)
+
+// Old slots migrated per insertion. Any value >= 2 finishes a migration
+// before the new array reaches its own load limit.
+#define HT_MIGRATE_STEP 16
+
 /* ========================================================================= */
 
 int ht_size(struct hash_table *ht) {
   return ht->size;
 }
 
+int ht_capacity(struct hash_table *ht) {
+  return ht->capacity;
+}
+
+void ht_set_probe_hook(struct hash_table *ht, void (*hook)(void *arg, int probes), void *arg)
+{
+  ht->probe_hook = hook;
+  ht->probe_arg = arg;
+}
+
 /* ========================================================================= */
 
+// Smallest power of 2 that is greater than or equal to `n`.
+static int round_up_pow2(long n)
+{
+  int pow = 8;
+  while (pow < n)
+    pow <<= 1;
+  return pow;
+}
+
 // Create a hash table with `ht_size` # buckets, with each bucket occupying `bucket_size` bytes.
+// The buckets are laid out as one flat array of slots: each bucket contributes as many
+// slots as the entries it could hold.
 struct hash_table *ht_create(int ht_size, int bucket_size, void (*destroy_func)(void *data))
 {
   if (ht_size == 0)
@@ -39,187 +83,230 @@ struct hash_table *ht_create(int ht_size, int bucket_size, void (*destroy_func)(
 
   struct hash_table *ht = malloc(sizeof(struct hash_table));
 
+  int entries_per_bucket = bucket_size / MIN_ACCEPTABLE_BUCKET_SIZE;
+  if (entries_per_bucket < 1)
+    entries_per_bucket = 1;
+
   ht->size = 0;
-  ht->num_of_buckets = ht_size;
-  ht->buckets = calloc(ht_size, sizeof(struct bucket *)); // Bucket array
+  ht->capacity = round_up_pow2((long)ht_size * entries_per_bucket);
+  ht->slots = calloc(ht->capacity, sizeof(struct ht_slot));  // Every slot starts empty (hash 0).
+  ht->old_slots = NULL;
+  ht->old_capacity = ht->migrated = 0;
+  ht->probe_hook = NULL;
   ht->destroy_func = destroy_func;
 
-  // Amount of entries a bucket can hold, rounded to the closest integer to avoid fragmentation.
-  ht->num_of_entries = bucket_size / MIN_ACCEPTABLE_BUCKET_SIZE;
-
-  for (int i = 0; i < ht_size; ++i) // Allocate buckets.
-  {
-    ht->buckets[i] = calloc(1, sizeof(struct bucket));
-    ht->buckets[i]->entries = calloc(ht->num_of_entries, sizeof(struct bucket_entry *));
-  }
-
   return ht;
 }
 
 /* ========================================================================= */
 
-static int hash_function(char *str, int size){
-  unsigned long hash = 5381;
+static unsigned int hash_function(char *str)
+{
+  uint64_t hash = 5381;
   int c;
   while ((c = *str++))
     hash = ((hash << 5) + hash) + c;  /* hash * 33 + c */
-  return (hash % size);
+
+  // djb2 leaves keys that differ only in their last characters (e.g. sequential ids) in
+  // neighbouring values, which cluster once masked, so mix every bit into the low ones
+  // (murmur3's fmix64).
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+
+  unsigned int res = (unsigned int)hash;
+  return res ? res : 1;  // 0 is reserved for empty slots.
 }
 
-static struct bucket_entry *create_entry(char *key, void *data)
-{
-  struct bucket_entry *entry = malloc(sizeof(struct bucket_entry));
-  entry->key = key;
-  entry->data = data;
-  return entry;
+// Distance of the slot at `index` from the slot its `hash` maps to.
+static int probe_distance(struct hash_table *ht, unsigned int hash, int index) {
+  return (index - (int)(hash & (ht->capacity - 1))) & (ht->capacity - 1);
 }
 
-// Linear search the bucket for an empty slot. Insert and return true if such slot was found.
-static bool insert_at_empty(int size, struct bucket *b, struct bucket_entry *entry)
+// Place an entry with `hash` in the table, without checking the load factor.
+// Robin Hood: an entry that is further from its home slot takes the place of a closer one.
+static void insert_slot(struct hash_table *ht, unsigned int hash, struct bucket_entry entry)
 {
-  for (int i = 0; i < size; ++i)
-  {      
-    if (b->entries[i] == NULL) // Found empty pos.
+  int mask = ht->capacity - 1;
+  int index = hash & mask;
+  int dist = 0;
+
+  while (true)
+  {
+    struct ht_slot *slot = &ht->slots[index];
+    if (slot->hash == 0)  // Found an empty slot, insert.
     {
-      b->entries[i] = entry;  // Insert
-      return true;
+      slot->hash = hash;
+      slot->entry = entry;
+      return;
     }
-  }
 
-  return false; // Didn't find an empty slot, bucket is full.
-}
+    int slot_dist = probe_distance(ht, slot->hash, index);
+    if (slot_dist < dist)  // The resident entry is closer to its home, so displace it.
+    {
+      struct ht_slot tmp = *slot;
+      slot->hash = hash;
+      slot->entry = entry;
 
-// Insert `data` with `key` in the hash table.
-void ht_insert(struct hash_table *ht, char *key, void *data)
-{
-  ++ht->size;
+      hash = tmp.hash;    // Continue by placing the displaced entry.
+      entry = tmp.entry;
+      dist = slot_dist;
+    }
 
-  int index = hash_function(key, ht->num_of_buckets);  // Get index of the bucket.
+    index = (index + 1) & mask;
+    ++dist;
+  }
+}
 
-  struct bucket_entry *entry = create_entry(key, data);
-  struct bucket *curr = ht->buckets[index];
-  struct bucket *last;    // Keep the last bucket visited.
+// Move up to `count` slots of the old array to the new one.
+// Free the old array once every slot has been moved.
+static void migrate(struct hash_table *ht, int count)
+{
+  if (ht->old_slots == NULL)
+    return;
 
-  while (curr)  // Traverse the chain of buckets.
+  for (; count > 0 && ht->migrated < ht->old_capacity; --count)
   {
-    if (insert_at_empty(ht->num_of_entries, curr, entry) == true)
-      return;   // We inserted the entry.
+    struct ht_slot *slot = &ht->old_slots[ht->migrated++];
+    if (slot->hash != 0)
+      insert_slot(ht, slot->hash, slot->entry);
+  }
 
-    last = curr;
-    curr = curr->next;
+  if (ht->migrated == ht->old_capacity)  // Migration completed.
+  {
+    free(ht->old_slots);
+    ht->old_slots = NULL;
+    ht->old_capacity = ht->migrated = 0;
   }
-  // Every bucket in the chain is full, so create a new one.
-  last->next = calloc(1, sizeof(struct bucket));
-  last->next->entries = calloc(ht->num_of_entries, sizeof(struct bucket_entry *));
-  // And insert the entry.
-  last->next->entries[0] = entry;
 }
-/* ========================================================================= */
 
-// Return the value associated with the `key` given.
-// Return NULL if the `key` was not found.
-void *ht_search(struct hash_table *ht, char *key)
+// Allocate a slot array of double capacity and start migrating to it.
+static void grow(struct hash_table *ht)
 {
-  int index = hash_function(key, ht->num_of_buckets);
+  ht->old_slots = ht->slots;
+  ht->old_capacity = ht->capacity;
+  ht->migrated = 0;
 
-  struct bucket *b = ht->buckets[index];
-  while (b)  // Traverse the chain of buckets.
-  {
-    for (int i = 0; i < ht->num_of_entries; ++i)
-    {
-      if (b->entries[i] == NULL) // Found empty position in bucket, so stop.
-        return NULL;
+  ht->capacity *= 2;
+  ht->slots = calloc(ht->capacity, sizeof(struct ht_slot));
+}
 
-      if (strcmp(key, b->entries[i]->key) == 0) // Found the data.
-        return b->entries[i]->data;
-    }
+// Insert `data` with `key` in the hash table.
+void ht_insert(struct hash_table *ht, char *key, void *data)
+{
+  if (ht->old_slots != NULL)
+    migrate(ht, HT_MIGRATE_STEP);
+  else if (ht->size + 1 > HT_MAX_LOAD(ht->capacity))
+    grow(ht);
 
-    b = b->next;
-  }
+  ++ht->size;
 
-  return NULL;  // Visited every bucket in the chain, value not found.
+  struct bucket_entry entry = { .key = key, .data = data };
+  insert_slot(ht, hash_function(key), entry);
 }
-
 /* ========================================================================= */
 
-// Destroy a bucket and its `size` entries.
-static void destroy_bucket(int size, struct bucket *b, void (*destroy_func)(void *data))
+// Return the slot of `slots` (with `capacity`) that stores `key`, NULL if there is none.
+// The slots probed are added to `*probes`.
+static struct ht_slot *find_slot(struct ht_slot *slots, int capacity, unsigned int hash, char *key, int *probes)
 {
-  if (b->next)  // Destroy the linked bucket first.
-  {
-    destroy_bucket(size, b->next, destroy_func);
-    free(b->next);
-  }
+  int mask = capacity - 1;
+  int index = hash & mask;
 
-  for (int i = 0; i < size; ++i)  // Destroy entries.
+  for (int dist = 0; ; ++dist)  // Probe until an empty slot, or an entry closer to its home than we are.
   {
-    if (b->entries[i] == NULL)
-      break;
+    struct ht_slot *slot = &slots[index];
+    if (slot->hash == 0 || ((index - (int)(slot->hash & mask)) & mask) < dist)
+    {
+      *probes += dist + 1;
+      return NULL;
+    }
 
-    if (destroy_func != NULL)
+    if (slot->hash == hash && strcmp(key, slot->entry.key) == 0)  // Found the key.
     {
-      destroy_func(b->entries[i]->data);
-      free(b->entries[i]);
+      *probes += dist + 1;
+      return slot;
     }
+
+    index = (index + 1) & mask;
   }
+}
+
+// Return the value associated with the `key` given.
+// Return NULL if the `key` was not found.
+void *ht_search(struct hash_table *ht, char *key)
+{
+  unsigned int hash = hash_function(key);
+  int probes = 0;
+  struct ht_slot *slot = find_slot(ht->slots, ht->capacity, hash, key, &probes);
+
+  if (slot == NULL && ht->old_slots != NULL)  // Not migrated yet, it may still be in the old array.
+    slot = find_slot(ht->old_slots, ht->old_capacity, hash, key, &probes);
 
-  free(b->entries);
+  if (ht->probe_hook != NULL)
+    ht->probe_hook(ht->probe_arg, probes);
+
+  return slot ? slot->entry.data : NULL;
 }
 
+/* ========================================================================= */
+
 // Destroy the hash table.
 void ht_destroy(struct hash_table *ht)
 {
-  for (int i = 0; i < ht->num_of_buckets; ++i)  // Destroy every bucket.
+  migrate(ht, ht->old_capacity);  // Gather every entry in one array.
+
+  if (ht->destroy_func != NULL)
   {
-    destroy_bucket(ht->num_of_entries, ht->buckets[i], ht->destroy_func);
-    free(ht->buckets[i]);
+    for (int i = 0; i < ht->capacity; ++i)  // Destroy the data of every occupied slot.
+      if (ht->slots[i].hash != 0)
+        ht->destroy_func(ht->slots[i].entry.data);
   }
 
-  free(ht->buckets);
+  free(ht->slots);
   free(ht);
 }
 
 /* ========================================================================= */
 
-// Traverse the hash table. In each call, returns a unique `bucket_entry *`
-// until every `bucket_entry *` has been traversed, so `NULL` is returned.
-struct bucket_entry *ht_traverse(struct hash_table *ht)
+// Iteration positions cover the slots of the current array, followed by the
+// not yet migrated slots of the old array (if a migration is in progress).
+static int num_slots(struct hash_table *ht) {
+  return ht->capacity + (ht->old_slots ? ht->old_capacity : 0);
+}
+
+// Prepare `it` to iterate over every entry of `ht`.
+void ht_iter_init(struct ht_iter *it, struct hash_table *ht)
 {
-  static int bucket, entry;   // Counters to track our position at the ht.
-  static bool set_ht = true;
-  static struct bucket *curr;
-  
-  if (ht == NULL) return NULL;
+  it->ht = ht;
+  it->pos = 0;
+}
 
-  if (set_ht == true) // First call of the parse.
-  {
-    curr = ht->buckets[0];
-    bucket = entry = 0;     // Reset counters.
-    set_ht = false;
-  }
+// Returns the next entry of the iteration, or NULL if every entry has been visited.
+struct bucket_entry *ht_iter_next(struct ht_iter *it)
+{
+  struct hash_table *ht = it->ht;
+  if (ht == NULL)
+    return NULL;
 
-  while (true)  // While no entry is found and we didn't exhaust the hash table.
+  while (it->pos < num_slots(ht))
   {
-    if (entry == ht->num_of_entries)  // We visited every entry in the bucket
-    {
-      entry = 0;
-
-      if (curr->next != NULL) // Current is not the last link of the  chain.
-        curr = curr->next;
-      else if (++bucket != ht->num_of_buckets)  // Move on to the next bucket
-        curr = ht->buckets[bucket];             // in the standard array.
-    }
-
-    if (bucket == ht->num_of_buckets)   // We finished parsing the hash table.
-    {
-      set_ht = true;      // Prepare for the next parse.
-      return NULL;
-    }
+    int pos = it->pos++;
+    struct ht_slot *curr;
 
-    if (curr->entries[entry] == NULL)
-      entry = ht->num_of_entries;   // We visited every entry in the bucket
+    if (pos < ht->capacity)
+      curr = &ht->slots[pos];
+    else if (pos - ht->capacity >= ht->migrated)  // Skip old slots that were already moved.
+      curr = &ht->old_slots[pos - ht->capacity];
     else
-      return curr->entries[entry++];
+      continue;
+
+    if (curr->hash != 0)
+      return &curr->entry;
   }
+
+  return NULL;  // We finished iterating.
 }
-/* ========================================================================= */
\ No newline at end of file
+/* ========================================================================= */
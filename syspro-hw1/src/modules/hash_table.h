@@ -24,9 +24,28 @@ void *ht_search(struct hash_table *ht, char *key);
 
 int ht_size(struct hash_table *ht);
 
-// Traverse the hash table. In each call, returns a unique `bucket_entry *`.
-// Returns NULL if every `bucket_entry *` has been traversed.
-struct bucket_entry *ht_traverse(struct hash_table *ht);
+// Number of slots of the table.
+int ht_capacity(struct hash_table *ht);
+
+// Call `hook(arg, probes)` with the slots probed by every search (e.g. to gather stats). No hook by default.
+// The hook may be called by several threads at once, if they search concurrently.
+void ht_set_probe_hook(struct hash_table *ht, void (*hook)(void *arg, int probes), void *arg);
+
+// Iterator over the entries of a hash table. Iterators keep no hidden state,
+// so any number of them can be active at once (e.g. one per thread).
+struct ht_iter
+{
+  struct hash_table *ht;
+  int pos;  // Next slot to visit.
+};
+
+// Prepare `it` to iterate over every entry of `ht`.
+void ht_iter_init(struct ht_iter *it, struct hash_table *ht);
+
+// Returns a unique `bucket_entry *` in each call.
+// Returns NULL if every `bucket_entry *` has been visited.
+// The entry is stored inside the table: it is valid until the next insertion or `ht_destroy`.
+struct bucket_entry *ht_iter_next(struct ht_iter *it);
 
 
 #endif
\ No newline at end of file
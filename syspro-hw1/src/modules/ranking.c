@@ -0,0 +1,97 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ranking.h"
+
+/* ========================================================================= */
+
+struct ranking
+{
+  struct rank_entry *items;  // Sorted in descending order.
+  int size;
+  int capacity;
+  int *pos;         // Position of every ID in `items`, -1 if absent.
+  int pos_size;
+};
+
+#define RANKING_INIT_CAPACITY 8
+
+/* ========================================================================= */
+
+struct ranking *ranking_create(void) {
+  return calloc(1, sizeof(struct ranking));
+}
+
+void ranking_destroy(struct ranking *r)
+{
+  free(r->items);
+  free(r->pos);
+  free(r);
+}
+
+int ranking_size(struct ranking *r) {
+  return r->size;
+}
+
+struct rank_entry *ranking_get(struct ranking *r, int i) {
+  return &r->items[i];
+}
+
+/* ========================================================================= */
+
+// True if `a` belongs before `b`.
+static bool precedes(struct rank_entry *a, struct rank_entry *b)
+{
+  if (a->count != b->count)
+    return a->count > b->count;
+  return strcmp(a->name, b->name) < 0;
+}
+
+// Add item `id` at the end of the ranking, with count 0.
+static void append(struct ranking *r, int id, char *name)
+{
+  if (id >= r->pos_size)  // Make room for the position of `id`.
+  {
+    int new_size = r->pos_size ? r->pos_size : RANKING_INIT_CAPACITY;
+    while (new_size <= id)
+      new_size *= 2;
+
+    r->pos = realloc(r->pos, new_size * sizeof(int));
+    for (int i = r->pos_size; i < new_size; ++i)
+      r->pos[i] = -1;
+    r->pos_size = new_size;
+  }
+
+  if (r->size == r->capacity)
+  {
+    r->capacity = r->capacity ? 2 * r->capacity : RANKING_INIT_CAPACITY;
+    r->items = realloc(r->items, r->capacity * sizeof(struct rank_entry));
+  }
+
+  r->items[r->size] = (struct rank_entry){ .name = name, .id = id, .count = 0 };
+  r->pos[id] = r->size++;
+}
+
+// Increment the counter of item `id`, named `name`. The item is added with count 1, if absent.
+void ranking_increment(struct ranking *r, int id, char *name)
+{
+  if (id >= r->pos_size || r->pos[id] < 0)
+    append(r, id, name);
+
+  int i = r->pos[id];
+  r->items[i].count++;
+
+  while (i > 0 && precedes(&r->items[i], &r->items[i - 1]))  // Move it up, past the items it now precedes.
+  {
+    struct rank_entry tmp = r->items[i - 1];
+    r->items[i - 1] = r->items[i];
+    r->items[i] = tmp;
+
+    r->pos[r->items[i].id] = i;
+    --i;
+  }
+  r->pos[id] = i;
+}
+
+/* ========================================================================= */
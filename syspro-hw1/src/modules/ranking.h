@@ -0,0 +1,30 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+// Counters of items (given by dense integer IDs), kept sorted in descending order of
+// count, with ties broken by ascending name. Counters only grow one at a time, so an
+// increment moves its item just past the items it ties with, and the top `k` items
+// can be read in O(k) at any time.
+struct ranking;
+
+struct rank_entry
+{
+  char *name;
+  int id;
+  int count;
+};
+
+struct ranking *ranking_create(void);
+
+// Increment the counter of item `id`, named `name`. The item is added with count 1, if absent.
+void ranking_increment(struct ranking *r, int id, char *name);
+
+// Number of items in the ranking.
+int ranking_size(struct ranking *r);
+
+// Returns the item at position `i` (0 is the one with the greatest count).
+struct rank_entry *ranking_get(struct ranking *r, int i);
+
+void ranking_destroy(struct ranking *r);
+
+#endif
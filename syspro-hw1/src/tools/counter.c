@@ -0,0 +1,28 @@
+#include "counter.h"
+
+_Thread_local struct counter_pending counter_cache[COUNTER_CACHE_SIZE];
+_Thread_local int counter_cached;
+
+/* ========================================================================= */
+
+void counter_publish(void)
+{
+  for (int i = 0; i < counter_cached; ++i)
+  {
+    struct counter_pending *p = &counter_cache[i];
+    struct counter *c = p->counter;
+
+    atomic_fetch_add_explicit(&c->count, p->count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&c->sum, p->sum, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&c->max, memory_order_relaxed);
+    while (p->max > max && !atomic_compare_exchange_weak_explicit(&c->max, &max, p->max, memory_order_relaxed, memory_order_relaxed))
+      ;
+  }
+  counter_cached = 0;
+}
+
+void counter_hook(void *c, int value) {
+  counter_add(c, value);
+}
+/* ========================================================================= */
@@ -0,0 +1,75 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Count, sum & max of a value measured on every operation (e.g. the probes of a lookup).
+// The structures only report their measurements to their callers, which add them to counters.
+// The totals are shared, updated with relaxed atomics. A thread adds its values to a cache of its own,
+// without atomics, and publishes them to the totals with `counter_publish` (e.g. once per command),
+// so operations that run in parallel don't contend for the counters they share.
+struct counter
+{
+  _Atomic uint64_t count;
+  _Atomic uint64_t sum;
+  _Atomic uint64_t max;
+};
+
+#define COUNTER_CACHE_SIZE 8  // Counters a thread updates between publications. More publish the rest early.
+
+// Values added to `counter` by a thread, not published yet.
+struct counter_pending
+{
+  struct counter *counter;
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+};
+
+extern _Thread_local struct counter_pending counter_cache[COUNTER_CACHE_SIZE];
+extern _Thread_local int counter_cached;
+
+// Add the values cached by the calling thread to their counters, and empty its cache.
+// A thread must publish before it exits, and before a counter it updated is freed.
+void counter_publish(void);
+
+static inline void counter_add(struct counter *c, uint64_t value)
+{
+  struct counter_pending *p = counter_cache;
+  while (p < counter_cache + counter_cached && p->counter != c)
+    ++p;
+
+  if (p == counter_cache + counter_cached)  // 1st value of `c` since the last publication.
+  {
+    if (counter_cached == COUNTER_CACHE_SIZE)
+      counter_publish();
+    p = &counter_cache[counter_cached++];
+    *p = (struct counter_pending){ .counter = c };
+  }
+
+  p->count++;
+  p->sum += value;
+  if (value > p->max)
+    p->max = value;
+}
+
+// Adds `value` to the counter `c`: a probe hook of a hash table (see `ht_set_probe_hook`).
+void counter_hook(void *c, int value);
+
+static inline uint64_t counter_count(struct counter *c) {
+  return atomic_load_explicit(&c->count, memory_order_relaxed);
+}
+
+static inline uint64_t counter_max(struct counter *c) {
+  return atomic_load_explicit(&c->max, memory_order_relaxed);
+}
+
+// Average of the values published, 0 if none.
+static inline double counter_avg(struct counter *c)
+{
+  uint64_t count = counter_count(c);
+  return count ? (double)atomic_load_explicit(&c->sum, memory_order_relaxed) / count : 0.0;
+}
+
+#endif
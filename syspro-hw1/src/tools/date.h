@@ -2,16 +2,49 @@
 #define DATE_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>  // FILE
 
+// A date is packed in a single 64-bit key: the date as yyyymmdd in the upper 32 bits,
+// and an ID in the lower 32, that tells apart equal entry dates.
+// Ordering dates (with IDs) is then one integer comparison.
 struct date
 {
-  bool active;  // true if it contains a date, false if date not set ("-").
-  int day;
-  int month;
-  int year;
-  unsigned long long id;  // Unique identifier between entry dates.
+  uint64_t key;
 };
 
+#define DATE_NONE UINT32_MAX   // yyyymmdd of a date not set ("-"), greater than every date.
+
+#define DATE_ID_MIN 0            // ID of dummy beginning dates.
+#define DATE_ID_MAX UINT32_MAX   // ID of dummy ending dates.
+
+// Returns the date as yyyymmdd, DATE_NONE if not set.
+static inline uint32_t date_ymd(const struct date *d) {
+  return d->key >> 32;
+}
+
+// Returns the ID of the date.
+static inline uint32_t date_id(const struct date *d) {
+  return (uint32_t)d->key;
+}
+
+// True if `d` contains a date, false if date not set ("-").
+static inline bool date_active(const struct date *d) {
+  return date_ymd(d) != DATE_NONE;
+}
+
+// Day number of a date that is set, increasing with the date. Every month counts as 31 days,
+// so a few numbers are skipped between some consecutive dates, but no two dates share one.
+static inline int date_day_index(const struct date *d)
+{
+  uint32_t ymd = date_ymd(d);
+  return (ymd / 10000) * 372 + (ymd / 100 % 100) * 31 + ymd % 100;
+}
+
+static inline void date_clear(struct date *d) {
+  d->key = (uint64_t)DATE_NONE << 32;
+}
+
 enum date_type
 {
   EXIT,
@@ -20,10 +53,12 @@ enum date_type
   DUMMY_END,
 };
 
-void print_date(struct date *d);
+void print_date(FILE *out, struct date *d);
 
 void convert_str_to_date(char *str, struct date *d, enum date_type type);
 
+void date_reserve_entry_ids(uint32_t id);
+
 int compare_dates(void *a, void *b);
 int compare_prec_entry_dates(void *a, void *b);
 
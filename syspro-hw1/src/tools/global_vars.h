@@ -1,15 +1,38 @@
 #ifndef GLOBAL_H
 #define GLOBAL_H
 
+#include "admissions.h"
+#include "arena.h"
 #include "hash_table.h"
+#include "symbol_table.h"
 #include "binary_heap.h"
+#include "counter.h"
 #include "date.h"
 
+#define MAX_THREADS 64
+
+// How the structures behaved, as reported by `/stats`.
+struct structure_stats
+{
+  struct counter patients_probes;  // Slots probed per search of each ht.
+  struct counter disease_probes;
+  struct counter country_probes;
+  struct counter range_nodes;      // Fenwick nodes visited per range count.
+  struct counter heap_inserted;    // Elements given to each topk heap.
+  struct counter heap_peak;        // Elements kept by each topk heap at once, at most.
+};
+
 struct global_vars
 {
   struct hash_table *disease_ht;  // Disease hash table
   struct hash_table *country_ht;  // Country hash table
   struct hash_table *patients_ht; // Patient hash table
+  struct symbol_table *diseases;  // Disease names, interned to IDs
+  struct symbol_table *countries; // Country names, interned to IDs
+  struct arena *records;          // Patient records & their names
+  struct admissions *admissions;  // Admissions per day, by disease & country
+  int threads;                    // Most threads a parallel operation uses (-t)
+  struct structure_stats stats;
 };
 
 #endif
\ No newline at end of file
@@ -1,26 +1,66 @@
 
 #include <errno.h>
 #include <ctype.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "date.h"
 #include "stats.h"
+#include "fenwick.h"
+#include "global_vars.h"
+#include "latency.h"
 #include "patients.h"
+#include "snapshot.h"
+#include "wal.h"
 #include "utilities.h"
 #include "interface.h"
 
+extern struct global_vars global;
+
 /* ========================================================================= */
 
 enum function_t
 {
   GLOB_DIS_STATS, DIS_FREQ, TOP_DIS, TOP_CTR, INS_PAT_REC,
-  REC_PAT_EXT, NUM_CURR_PAT, EXT
+  REC_PAT_EXT, NUM_CURR_PAT, SNAPSHOT, STATS, EXT,
+  INVALID,   // Unknown command, or invalid arguments.
+  EMPTY,     // Blank line.
+  NUM_FUNCS
+};
+
+// Names of the commands, as reported by `/stats`.
+static const char *func_names[NUM_FUNCS] =
+{
+  "/globalDiseaseStats", "/diseaseFrequency", "/topk-Diseases", "/topk-Countries", "/insertPatientRecord",
+  "/recordPatientExit", "/numCurrentPatients", "/snapshot", "/stats", "/exit",
+  "(invalid)", "(empty)",
 };
 
-static bool is_valid(enum function_t func, char **args);
+#define MAX_ARGS 7
+
+// A command line, split in its arguments (which point in the line).
+struct command
+{
+  enum function_t func;
+  char *args[MAX_ARGS];
+};
+
+#define BATCH_MAX_RUN 4096       // Most read-only commands run together.
+#define BATCH_MIN_PART 64        // Least commands per thread, fewer aren't worth one.
+
+// Latencies of every command run, one histogram per command type.
+static struct latency_hist latencies[NUM_FUNCS];
+
+// Output of the updates logged since the last commit, held back until they are durable. NULL if empty.
+static FILE *held;
+static char *held_output;
+static size_t held_size;
+
 static bool has_valid_args(enum function_t func, char **args);
 static bool is_valid_range(char *sdate1, char *sdate2);
 
@@ -38,15 +78,6 @@ static bool is_valid_range(char *sdate1, char *sdate2)
   return true;
 }
 
-static bool is_valid(enum function_t func, char **args)
-{
-  if (has_valid_args(func, args))
-    return true;
-
-  printf("error\n");
-  return false;
-}
-
 static bool has_valid_args(enum function_t func, char **args)
 {
   if (strtok(NULL, " \n"))  // More arguments given.
@@ -84,7 +115,13 @@ static bool has_valid_args(enum function_t func, char **args)
         return false;
       return true;
 
+    case SNAPSHOT:
+      if (!args[0])
+        return false;
+      return true;
+
     case NUM_CURR_PAT:
+    case STATS:
     case EXT:
     default:
       return true;
@@ -96,110 +133,404 @@ static bool has_valid_args(enum function_t func, char **args)
 
 /* ========================================================================= */
 
+// Split `line` in a command and its arguments, and check them.
+static void parse_command(char *line, struct command *cmd)
+{
+  memset(cmd->args, 0, sizeof(cmd->args));
+
+  char *command = strtok(line, " \n");
+  int num_args = 0;
+
+  if (!command)
+    cmd->func = EMPTY;
+  else if (!strcmp(command, "/globalDiseaseStats"))
+    cmd->func = GLOB_DIS_STATS, num_args = 2;
+  else if (!strcmp(command, "/diseaseFrequency"))
+    cmd->func = DIS_FREQ, num_args = 4;
+  else if (!strcmp(command, "/topk-Diseases"))
+    cmd->func = TOP_DIS, num_args = 4;
+  else if (!strcmp(command, "/topk-Countries"))
+    cmd->func = TOP_CTR, num_args = 4;
+  else if (!strcmp(command, "/insertPatientRecord"))
+    cmd->func = INS_PAT_REC, num_args = 7;
+  else if (!strcmp(command, "/recordPatientExit"))
+    cmd->func = REC_PAT_EXT, num_args = 2;
+  else if (!strcmp(command, "/numCurrentPatients"))
+    cmd->func = NUM_CURR_PAT, num_args = 1;
+  else if (!strcmp(command, "/snapshot"))
+    cmd->func = SNAPSHOT, num_args = 1;
+  else if (!strcmp(command, "/stats"))
+    cmd->func = STATS;
+  else if (!strcmp(command, "/exit"))
+    cmd->func = EXT;
+  else
+    cmd->func = INVALID;
+
+  if (cmd->func == EMPTY || cmd->func == INVALID)
+    return;
+
+  for (int i = 0; i < num_args; ++i)
+    cmd->args[i] = strtok(NULL, " \n");
+
+  if (!has_valid_args(cmd->func, cmd->args))
+    cmd->func = INVALID;
+}
+
+// True if `cmd` only reads the structures, so it may run in parallel with other such commands.
+static bool is_read_only(struct command *cmd)
+{
+  switch (cmd->func)
+  {
+    case GLOB_DIS_STATS:
+    case DIS_FREQ:
+    case TOP_DIS:
+    case TOP_CTR:
+    case NUM_CURR_PAT:
+    case INVALID:
+    case EMPTY:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// True if `cmd` updates the structures, so it is logged.
+static bool is_update(struct command *cmd)
+{
+  return cmd->func == INS_PAT_REC || cmd->func == REC_PAT_EXT;
+}
+
+static void print_ht_stats(FILE *out, const char *name, struct hash_table *ht, struct counter *probes)
+{
+  fprintf(out, "%-22s %10d %10d %12lu %12.2f %12lu\n", name, ht_size(ht), ht_capacity(ht),
+          (unsigned long)counter_count(probes), counter_avg(probes), (unsigned long)counter_max(probes));
+}
+
+// Print the latency percentiles of every command type run, and how the structures behaved:
+// the probes per hash table search, the Fenwick nodes visited per date range, and the sizes of the topk heaps.
+static void print_stats(FILE *out)
+{
+  counter_publish();  // Along with the command printing them.
+
+  fprintf(out, "%-22s %10s %12s %12s %12s\n", "command", "count", "p50 (us)", "p99 (us)", "p999 (us)");
+  for (int f = 0; f < NUM_FUNCS; ++f)
+  {
+    if (f == EMPTY || latencies[f].count == 0)
+      continue;
+
+    fprintf(out, "%-22s %10lu %12.2f %12.2f %12.2f\n", func_names[f], (unsigned long)latencies[f].count,
+            latency_percentile(&latencies[f], 0.5) / 1e3, latency_percentile(&latencies[f], 0.99) / 1e3,
+            latency_percentile(&latencies[f], 0.999) / 1e3);
+  }
+
+  fprintf(out, "%-22s %10s %10s %12s %12s %12s\n", "hash table", "entries", "slots", "searches", "avg probes", "max probes");
+  print_ht_stats(out, "patients", global.patients_ht, &global.stats.patients_probes);
+  print_ht_stats(out, "diseases", global.disease_ht, &global.stats.disease_probes);
+  print_ht_stats(out, "countries", global.country_ht, &global.stats.country_probes);
+
+  struct counter *nodes = &global.stats.range_nodes;
+  fprintf(out, "%-22s %10s %12s %12s\n", "range sums", "count", "avg nodes", "max nodes");
+  fprintf(out, "%-22s %10lu %12.2f %12lu\n", "fenwick", (unsigned long)counter_count(nodes),
+          counter_avg(nodes), (unsigned long)counter_max(nodes));
+
+  struct counter *inserted = &global.stats.heap_inserted, *peak = &global.stats.heap_peak;
+  fprintf(out, "%-22s %10s %12s %12s %12s %12s\n", "heaps", "count", "avg inserted", "max inserted", "avg peak", "max peak");
+  fprintf(out, "%-22s %10lu %12.2f %12lu %12.2f %12lu\n", "topk", (unsigned long)counter_count(inserted),
+          counter_avg(inserted), (unsigned long)counter_max(inserted),
+          counter_avg(peak), (unsigned long)counter_max(peak));
+}
+
+// Run `cmd`, printing its output to `out`. Commands that aren't read-only always run
+// on the main thread, with `out` being stdout (or the held output, for updates).
+// Returns `false` if the app should terminate.
+static bool run_command(struct command *cmd, FILE *out)
+{
+  char **args = cmd->args;
+
+  switch (cmd->func)
+  {
+    case GLOB_DIS_STATS:
+      global_disease_stats(out, args[0], args[1]);
+      return true;
+
+    case DIS_FREQ:
+      disease_frequency(out, args[0], args[1], args[2], args[3]);
+      return true;
+
+    case TOP_DIS:
+      topk_diseases(out, atoi(args[0]), args[1], args[2], args[3]);
+      return true;
+
+    case TOP_CTR:
+      topk_countries(out, atoi(args[0]), args[1], args[2], args[3]);
+      return true;
+
+    case NUM_CURR_PAT:
+      num_current_patients(out, args[0]);
+      return true;
+
+    case INS_PAT_REC:
+      if (!insert_patient_record(args[0], args[1], args[2], args[3], args[4], args[5], args[6]))
+      {
+        fprintf(out, "error\nexiting\n");
+        return false;  // Terminate the app if the insertion failed.
+      }
+      wal_log_insert(args[0], args[1], args[2], args[3], args[4], args[5], args[6]);
+      fprintf(out, "Record added\n");
+      return true;
+
+    case REC_PAT_EXT:
+      if (record_patient_exit(out, args[0], args[1]))
+        wal_log_exit(args[0], args[1]);
+      return true;
+
+    case SNAPSHOT:
+      if (save_snapshot(args[0]))
+      {
+        wal_checkpoint();  // Every logged command is in the snapshot now.
+        fprintf(out, "Snapshot saved\n");
+      }
+      else
+        fprintf(out, "error\n");
+      return true;
+
+    case STATS:
+      print_stats(out);
+      return true;
+
+    case EXT:
+      fprintf(out, "exiting\n");
+      return false;
+
+    case INVALID:
+      fprintf(out, "error\n");
+      return true;
+
+    case EMPTY:
+    default:
+      return true;
+  }
+}
+
+// Same, recording its latency in `hists`, one histogram per command type.
+static bool run_timed(struct command *cmd, FILE *out, struct latency_hist *hists)
+{
+  uint64_t t = latency_now();
+  bool running = run_command(cmd, out);
+  latency_record(&hists[cmd->func], latency_now() - t);
+
+  counter_publish();  // Once per command, so the hot paths don't update the shared counters.
+  return running;
+}
+
+// Commit the logged updates, then print their held output.
+static void commit(void)
+{
+  wal_commit();
+  if (held == NULL)
+    return;
+
+  fclose(held);
+  fwrite(held_output, 1, held_size, stdout);
+  free(held_output);
+  held = NULL;
+}
+
+// Run `cmd` on the main thread. An update prints to the held output, which is committed once the group is due;
+// anything else runs after the updates before it are committed, since its output may reflect them.
+static bool run_main(struct command *cmd)
+{
+  if (!is_update(cmd))
+  {
+    commit();
+    return run_timed(cmd, stdout, latencies);
+  }
+
+  if (held == NULL)
+    held = open_memstream(&held_output, &held_size);
+
+  bool running = run_timed(cmd, held, latencies);
+  if (wal_commit_due())
+    commit();
+  return running;
+}
+
+/* ========================================================================= */
+
+// True if more input can be read without waiting.
+static bool input_ready(void)
+{
+  struct pollfd pfd = { .fd = fileno(stdin), .events = POLLIN };
+  return poll(&pfd, 1, 0) > 0;
+}
+
 void interface(void)
 {
   char *line = NULL;
   size_t len = 0;
+  struct command cmd;
 
   while (true)
   {
+    if (!input_ready())  // Commit the logged commands before waiting for more.
+      commit();
+
     if (getline(&line, &len, stdin) == -1)
       break;
 
-    char *command = strtok(line, " \n");
-    
-    if (!command)
-      continue;
+    parse_command(line, &cmd);
+    if (!run_main(&cmd))
+      break;
+  }
 
-    if (!strcmp(command, "/globalDiseaseStats"))
-    {
-      char *args[2];
-      for (int i = 0; i < 2; ++i)
-        args[i] = strtok(NULL, " \n");
+  commit();
+  free(line);
+  print_stats(stderr);
+}
 
-      if (is_valid(GLOB_DIS_STATS, args))
-        global_disease_stats(args[0], args[1]);
-    }
+/* ========================================================================= */
 
-    else if (!strcmp(command, "/diseaseFrequency"))
-    {
-      char *args[4];
-      for (int i = 0; i < 4; ++i)
-        args[i] = strtok(NULL, " \n");
+// Consecutive read-only commands, split in parts that run in parallel.
+struct run_part
+{
+  struct command *cmds;
+  int size;
+  char *output;        // Everything the commands printed, in order.
+  size_t output_size;
+  struct latency_hist *hists;
+};
 
-      if (is_valid(DIS_FREQ, args))
-        disease_frequency(args[0], args[1], args[2], args[3]);
-    }
+static void *run_part(void *arg)
+{
+  struct run_part *part = arg;
+
+  FILE *out = open_memstream(&part->output, &part->output_size);
+  for (int i = 0; i < part->size; ++i)
+    run_timed(&part->cmds[i], out, part->hists);
+  fclose(out);
+
+  return NULL;
+}
+
+static int num_threads(int n)
+{
+  int t = global.threads;
+  if (t > n / BATCH_MIN_PART)
+    t = n / BATCH_MIN_PART ? n / BATCH_MIN_PART : 1;
+  return t;
+}
+
+// Run the `n` read-only `cmds`, in parallel if there are enough of them.
+// Each thread runs a contiguous part and prints to its own buffer, so the output keeps the order of the commands.
+static void run_read_only(struct command *cmds, int n)
+{
+  if (n > 0)
+    commit();  // Their output may reflect the updates before them.
+
+  int t = num_threads(n);
+  if (t == 1)
+  {
+    for (int i = 0; i < n; ++i)
+      run_timed(&cmds[i], stdout, latencies);
+    return;
+  }
+
+  struct run_part parts[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+
+  for (int i = 0; i < t; ++i)
+  {
+    int beg = (long)n * i / t, end = (long)n * (i + 1) / t;
+    parts[i] = (struct run_part){ .cmds = cmds + beg, .size = end - beg };
+    parts[i].hists = (i == 0) ? latencies : calloc(NUM_FUNCS, sizeof(struct latency_hist));
+  }
 
-    else if (!strcmp(command, "/topk-Diseases"))
+  for (int i = 1; i < t; ++i)
+    if (pthread_create(&threads[i], NULL, run_part, &parts[i]) != 0)
     {
-      char *args[4];
-      for (int i = 0; i < 4; ++i)
-        args[i] = strtok(NULL, " \n");
-      
-      if (is_valid(TOP_DIS, args))
-        topk_diseases(atoi(args[0]), args[1], args[2], args[3]);
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
     }
 
-    else if (!strcmp(command, "/topk-Countries"))
-    {
-      char *args[4];
-      for (int i = 0; i < 4; ++i)
-        args[i] = strtok(NULL, " \n");
+  run_part(&parts[0]);  // The main thread runs the 1st part.
 
-      if (is_valid(TOP_CTR, args))
-        topk_countries(atoi(args[0]), args[1], args[2], args[3]);      
+  for (int i = 0; i < t; ++i)
+  {
+    if (i > 0)
+    {
+      pthread_join(threads[i], NULL);
+      for (int f = 0; f < NUM_FUNCS; ++f)
+        latency_merge(&latencies[f], &parts[i].hists[f]);
+      free(parts[i].hists);
     }
+    fwrite(parts[i].output, 1, parts[i].output_size, stdout);
+    free(parts[i].output);
+  }
+}
 
-    else if (!strcmp(command, "/insertPatientRecord"))
-    {
-      char *args[7];
-      for (int i = 0; i < 7; ++i)
-        args[i] = strtok(NULL, " \n");
+// Run the commands of every line of `fp`, back to back, and close it.
+// Consecutive read-only commands are gathered and run in parallel; the rest run one by one, in order.
+// The throughput and the stats are reported to stderr in the end.
+void batch(FILE *fp)
+{
+  setvbuf(fp, NULL, _IOFBF, BATCH_OUTPUT_BUFFER);
 
-      if (is_valid(INS_PAT_REC, args))
-      {
-        if (!insert_patient_record(args[0], args[1], args[2], args[3], args[4], args[5], args[6]))
-        {
-          printf("error\nexiting\n");
-          break;  // Terminate the app if the insertion failed.
-        }
-        else
-          printf("Record added\n");
-      }
-    }
+  char *lines[BATCH_MAX_RUN];   // The arguments of the gathered commands point in their lines.
+  struct command cmds[BATCH_MAX_RUN];
+  int gathered = 0;
+  long total = 0;
 
-    else if (!strcmp(command, "/recordPatientExit"))
-    {
-      char *args[2];
-      for (int i = 0; i < 2; ++i)
-        args[i] = strtok(NULL, " \n");
+  uint64_t beg = latency_now();
 
-      if (is_valid(REC_PAT_EXT, args))
-        record_patient_exit(args[0], args[1]);
+  bool running = true;
+  while (running)
+  {
+    char *line = NULL;
+    size_t len = 0;
+    struct command cmd;
+
+    bool more = getline(&line, &len, fp) != -1;
+    if (more)
+    {
+      parse_command(line, &cmd);
+      total += (cmd.func != EMPTY);
     }
 
-    else if (!strcmp(command, "/numCurrentPatients"))
+    // Run the gathered commands before anything that isn't read-only, when they are enough, or at the end.
+    bool gather = more && is_read_only(&cmd);
+    if (!gather || gathered == BATCH_MAX_RUN)
     {
-      char *arg = strtok(NULL, " \n");
+      run_read_only(cmds, gathered);
+      for (int i = 0; i < gathered; ++i)
+        free(lines[i]);
+      gathered = 0;
+    }
 
-      if (is_valid(NUM_CURR_PAT, NULL))
-        num_current_patients(arg);
+    if (!more)
+    {
+      free(line);
+      break;
     }
 
-    else if (!strcmp(command, "/exit"))
+    if (gather)
     {
-      if (is_valid(EXT, NULL))
-      {
-        printf("exiting\n");
-        break;
-      }
+      lines[gathered] = line;
+      cmds[gathered++] = cmd;
+      continue;
     }
 
-    else
-      printf("error\n");
+    running = run_main(&cmd);
+    free(line);
   }
 
-  free(line);
+  commit();
+  fflush(stdout);
+
+  double secs = (latency_now() - beg) / 1e9;
+  fprintf(stderr, "%ld commands in %.3f sec (%.0f commands/sec)\n", total, secs, secs > 0 ? total / secs : 0.0);
+  print_stats(stderr);
+
+  fclose(fp);
 }
-/* ========================================================================= */
\ No newline at end of file
+/* ========================================================================= */
@@ -1,3 +1,10 @@
+#include <stdio.h>  // FILE
 
+#define BATCH_OUTPUT_BUFFER (1 << 20)  // Bytes of stdout buffered in batch mode.
 
-void interface(void);
\ No newline at end of file
+// Read commands from stdin, one at a time, and run them.
+void interface(void);
+
+// Batch mode: run every command of `fp` back to back, with stdout fully buffered
+// (set up with `BATCH_OUTPUT_BUFFER` before anything is printed), and close `fp`.
+void batch(FILE *fp);
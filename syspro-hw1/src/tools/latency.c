@@ -0,0 +1,72 @@
+#include <time.h>
+
+#include "latency.h"
+
+/* ========================================================================= */
+
+// Latencies below `LATENCY_SUB_BUCKETS` ns get a bucket each. Greater ones go by their
+// highest bit, and the `LATENCY_SUB_BITS` bits below it.
+static int bucket_of(uint64_t ns)
+{
+  if (ns < LATENCY_SUB_BUCKETS)
+    return ns;
+
+  int high = 63 - __builtin_clzll(ns);
+  if (high > LATENCY_MAX_BITS)
+    return LATENCY_BUCKETS - 1;
+
+  int shift = high - LATENCY_SUB_BITS;
+  return (shift + 1) * LATENCY_SUB_BUCKETS + ((ns >> shift) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+// Least latency of bucket `b`.
+static uint64_t bucket_value(int b)
+{
+  if (b < LATENCY_SUB_BUCKETS)
+    return b;
+
+  int shift = b / LATENCY_SUB_BUCKETS - 1;
+  return (uint64_t)(LATENCY_SUB_BUCKETS + b % LATENCY_SUB_BUCKETS) << shift;
+}
+
+/* ========================================================================= */
+
+void latency_record(struct latency_hist *h, uint64_t ns)
+{
+  ++h->counts[bucket_of(ns)];
+  ++h->count;
+}
+
+void latency_merge(struct latency_hist *dst, const struct latency_hist *src)
+{
+  for (int b = 0; b < LATENCY_BUCKETS; ++b)
+    dst->counts[b] += src->counts[b];
+  dst->count += src->count;
+}
+
+uint64_t latency_percentile(const struct latency_hist *h, double p)
+{
+  if (h->count == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)(p * h->count);  // Latencies counted before the one asked.
+  if (rank >= h->count)
+    rank = h->count - 1;
+
+  uint64_t seen = 0;
+  for (int b = 0; b < LATENCY_BUCKETS; ++b)
+  {
+    seen += h->counts[b];
+    if (seen > rank)
+      return bucket_value(b);
+  }
+  return bucket_value(LATENCY_BUCKETS - 1);
+}
+
+uint64_t latency_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+/* ========================================================================= */
@@ -0,0 +1,32 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Histogram of latencies, in ns, with log-linear buckets: every power of 2
+// is split in `LATENCY_SUB_BUCKETS` buckets, so a percentile is off by less than 1/64.
+// Fixed size, so one can be kept per thread and merged afterwards.
+
+#define LATENCY_SUB_BITS 6
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS 40   // Longer latencies (over ~18 min) are counted in the last bucket.
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+struct latency_hist
+{
+  uint64_t count;
+  uint64_t counts[LATENCY_BUCKETS];
+};
+
+void latency_record(struct latency_hist *h, uint64_t ns);
+
+// Add the latencies of `src` to `dst`.
+void latency_merge(struct latency_hist *dst, const struct latency_hist *src);
+
+// Returns the latency below which a fraction `p` (e.g. 0.99) of the recorded ones fall, 0 if none.
+uint64_t latency_percentile(const struct latency_hist *h, double p);
+
+// Monotonic clock, in ns.
+uint64_t latency_now(void);
+
+#endif
@@ -0,0 +1,279 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "date.h"
+#include "loader.h"
+#include "patients.h"
+#include "global_vars.h"
+
+extern struct global_vars global;
+
+// Every chunk is parsed by its own thread, into its own arenas, so the threads share nothing.
+// Dates get their unique IDs from an atomic counter, the only shared state.
+// Once every thread is done, the records are added to the hts by the main thread,
+// chunk by chunk, which keeps the order (and the error messages) of the file.
+// Finally, the disease & country trees are built in bulk, from sorted batches.
+
+#define LOADER_MIN_CHUNK (1 << 20)  // Smaller files aren't worth a thread per core.
+
+#define LOADER_ARENA_BLOCK (1 << 16)
+#define LOADER_FIELDS 7
+
+// A line of the file, parsed.
+struct parsed_line
+{
+  struct patient_record *prec;  // NULL if the line is invalid.
+  char *disease;
+  char *country;
+};
+
+struct chunk
+{
+  const char *beg, *end;      // Lines of the file in [beg, end).
+  struct arena *records;      // Records & their names, merged to `global.records`.
+  struct arena *scratch;      // Disease & country names, until they are interned.
+  struct parsed_line *lines;
+  int size;
+  int capacity;
+};
+
+/* ========================================================================= */
+
+// Copy the token [beg, end) to `ar`, as a string.
+static char *copy_token(struct arena *ar, const char *beg, const char *end)
+{
+  char *str = arena_alloc_aligned(ar, end - beg + 1, 1);
+  memcpy(str, beg, end - beg);
+  str[end - beg] = '\0';
+  return str;
+}
+
+static void append_line(struct chunk *ch, struct patient_record *prec, char *disease, char *country)
+{
+  if (ch->size == ch->capacity)
+  {
+    ch->capacity = ch->capacity ? 2 * ch->capacity : 1024;
+    ch->lines = realloc(ch->lines, ch->capacity * sizeof(struct parsed_line));
+  }
+  ch->lines[ch->size++] = (struct parsed_line){ prec, disease, country };
+}
+
+// Parse the line [beg, end), with space separated fields:
+// record ID, first name, last name, disease, country, entry date, exit date.
+static void parse_line(struct chunk *ch, const char *beg, const char *end)
+{
+  char *fields[LOADER_FIELDS];
+  int num_fields = 0;
+
+  const char *p = beg;
+  while (num_fields < LOADER_FIELDS)
+  {
+    while (p < end && *p == ' ')
+      ++p;
+    if (p == end)
+      break;
+
+    const char *token = p;
+    while (p < end && *p != ' ')
+      ++p;
+    fields[num_fields++] = copy_token(ch->scratch, token, p);
+  }
+
+  if (num_fields == 0)  // Blank line.
+    return;
+
+  if (num_fields < LOADER_FIELDS)
+  {
+    append_line(ch, NULL, NULL, NULL);
+    return;
+  }
+
+  struct patient_record *prec = create_patient_record(ch->records, fields[0], fields[1], fields[2], fields[5], fields[6]);
+  if (compare_dates(&prec->entry_date, &prec->exit_date) > 0)  // Make sure the dates are given in order.
+    prec = NULL;
+
+  append_line(ch, prec, fields[3], fields[4]);
+}
+
+static void *parse_chunk(void *arg)
+{
+  struct chunk *ch = arg;
+
+  const char *p = ch->beg;
+  while (p < ch->end)
+  {
+    const char *eol = memchr(p, '\n', ch->end - p);
+    if (eol == NULL)  // Last line, without a newline.
+      eol = ch->end;
+
+    parse_line(ch, p, eol);
+    p = eol + 1;
+  }
+  return NULL;
+}
+
+/* ========================================================================= */
+
+// Add the records of `ch` in the database, in order, and append them to `added`.
+// Returns `false` on a duplicate record, after reporting it.
+static bool merge_chunk(struct chunk *ch, struct patient_record **added, int *num_added)
+{
+  for (int i = 0; i < ch->size; ++i)
+  {
+    struct parsed_line *line = &ch->lines[i];
+    if (line->prec == NULL)
+    {
+      printf("error\n");
+      continue;
+    }
+
+    if (!add_patient_record(line->prec, line->disease, line->country))
+    {
+      fprintf(stderr, "[ERROR] Duplicate patient given in file.\n Exiting.\n");
+      return false;
+    }
+    added[(*num_added)++] = line->prec;
+  }
+  return true;
+}
+
+/* ========================================================================= */
+
+static int num_threads(size_t size)
+{
+  size_t by_size = size / LOADER_MIN_CHUNK;
+
+  int n = global.threads;
+  if ((size_t)n > by_size)
+    n = by_size ? by_size : 1;
+  return n;
+}
+
+// Split [data, data + size) in `n` chunks, that end right after a newline.
+static void split_chunks(struct chunk *chunks, int n, const char *data, size_t size)
+{
+  const char *end = data + size;
+  const char *beg = data;
+
+  for (int i = 0; i < n; ++i)
+  {
+    const char *limit = (i == n - 1) ? end : data + size / n * (i + 1);
+    if (limit < beg)
+      limit = beg;
+
+    const char *eol = limit < end ? memchr(limit, '\n', end - limit) : NULL;
+    const char *chunk_end = (i == n - 1 || eol == NULL) ? end : eol + 1;
+
+    chunks[i] = (struct chunk){ .beg = beg, .end = chunk_end };
+    chunks[i].records = arena_create(LOADER_ARENA_BLOCK);
+    chunks[i].scratch = arena_create(LOADER_ARENA_BLOCK);
+    beg = chunk_end;
+  }
+}
+
+/* ========================================================================= */
+
+// Read the whole of `fp` in a malloc'ed buffer, for files that can't be mapped (e.g. pipes).
+static char *read_file(FILE *fp, size_t *size)
+{
+  size_t capacity = 1 << 16;
+  char *data = malloc(capacity);
+  size_t n;
+
+  *size = 0;
+  while ((n = fread(data + *size, 1, capacity - *size, fp)) > 0)
+  {
+    *size += n;
+    if (*size == capacity)
+      data = realloc(data, capacity *= 2);
+  }
+  return data;
+}
+
+// Load every patient record of `fp` in the database, and close it.
+// Returns `false` if the file has duplicate records.
+bool load_patient_records(FILE *fp)
+{
+  struct stat st;
+  size_t size = 0;
+  char *data = NULL;
+  bool mapped = false;
+
+  if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode))
+  {
+    size = st.st_size;
+    if (size == 0)  // Nothing to load (and nothing to map).
+    {
+      fclose(fp);
+      return true;
+    }
+
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (data == MAP_FAILED)
+      data = NULL;
+    else
+    {
+      mapped = true;
+      madvise(data, size, MADV_SEQUENTIAL);
+    }
+  }
+  if (data == NULL)
+    data = read_file(fp, &size);
+
+  int n = num_threads(size);
+  struct chunk *chunks = calloc(n, sizeof(struct chunk));
+  split_chunks(chunks, n, data, size);
+
+  pthread_t *threads = malloc(n * sizeof(pthread_t));
+  for (int i = 1; i < n; ++i)
+    if (pthread_create(&threads[i], NULL, parse_chunk, &chunks[i]) != 0)
+    {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+
+  parse_chunk(&chunks[0]);  // The main thread parses the 1st chunk.
+
+  for (int i = 1; i < n; ++i)
+    pthread_join(threads[i], NULL);
+
+  int total = 0;
+  for (int i = 0; i < n; ++i)
+    total += chunks[i].size;
+
+  struct patient_record **added = malloc((total ? total : 1) * sizeof(struct patient_record *));
+  int num_added = 0;
+
+  bool valid = true;
+  for (int i = 0; i < n; ++i)
+  {
+    if (valid)
+      valid = merge_chunk(&chunks[i], added, &num_added);
+
+    arena_merge(global.records, chunks[i].records);  // Records stay alive with the database.
+    arena_destroy(chunks[i].scratch);
+    free(chunks[i].lines);
+  }
+
+  // Build the disease & country trees from sorted batches, instead of one insertion per record.
+  index_patient_records(added, num_added);
+
+  free(added);
+  free(threads);
+  free(chunks);
+  if (mapped)
+    munmap(data, size);
+  else
+    free(data);
+  fclose(fp);
+
+  return valid;
+}
+/* ========================================================================= */
@@ -0,0 +1,13 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stdio.h>  // FILE
+#include <stdbool.h>
+
+// Load every patient record of `fp` in the database, and close it.
+// The file is mapped in memory and split in line-aligned chunks, which are parsed in parallel.
+// The records are then added in file order, so errors are reported as if read line by line.
+// Returns `false` if the file has duplicate records.
+bool load_patient_records(FILE *fp);
+
+#endif
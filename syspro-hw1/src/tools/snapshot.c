@@ -0,0 +1,375 @@
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "avl.h"
+#include "arena.h"
+#include "date.h"
+#include "patients.h"
+#include "snapshot.h"
+#include "global_vars.h"
+
+extern struct global_vars global;
+
+// A snapshot is a single file with no pointers, only offsets, laid out as:
+//
+//   header
+//   disease names     uint64_t[num_diseases]    offsets in the string pool, by disease ID
+//   country names     uint64_t[num_countries]   offsets in the string pool, by country ID
+//   records           struct snapshot_record[num_records], ordered by disease, then entry date
+//   country order     uint64_t[num_records]     indices of the records, ordered by country, then entry date
+//   string pool       every name, NUL terminated
+//
+// Loading maps the file and validates it, copies the string pool in one go, and
+// rebuilds the hts & admissions from the packed records. The trees are built in bulk,
+// from the 2 stored orders, so nothing is parsed or sorted.
+
+#define SNAPSHOT_MAGIC "DMSNAP\0\0"
+#define SNAPSHOT_VERSION 1
+
+struct snapshot_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;     // sizeof(struct snapshot_record), to reject a different layout.
+  uint32_t num_diseases;
+  uint32_t num_countries;
+  uint64_t num_records;
+  uint64_t strings_size;
+  uint64_t file_size;
+};
+
+struct snapshot_record
+{
+  uint64_t entry_key;       // Keys of the dates, IDs included.
+  uint64_t exit_key;
+  uint64_t record_id;       // Offsets in the string pool.
+  uint64_t first_name;
+  uint64_t last_name;
+  int32_t disease;
+  int32_t country;
+};
+
+/* ========================================================================= */
+
+// Index of a record in the stored order, looked up by its address.
+struct record_index
+{
+  struct patient_record *prec;
+  uint64_t index;
+};
+
+static int compare_record_index(const void *a, const void *b)
+{
+  const struct record_index *r1 = a, *r2 = b;
+  return (r1->prec > r2->prec) - (r1->prec < r2->prec);
+}
+
+// Store in `precs` the records of every tree of `info`, by ID of `fields`, each in order.
+// Returns the number of records stored.
+static int collect_records(struct patient_record **precs, struct hash_table *info, struct symbol_table *fields)
+{
+  int n = 0;
+  for (int id = 0; id < symtab_size(fields); ++id)
+  {
+    struct avl *tree = ht_search(info, symtab_name(fields, id));
+    for (struct avl_node *node = avl_first(tree); node != NULL; node = avl_next(tree, node))
+      precs[n++] = avl_node_value(node);
+  }
+  return n;
+}
+
+static bool write_all(FILE *fp, const void *data, size_t size) {
+  return size == 0 || fwrite(data, size, 1, fp) == 1;
+}
+
+// Write the names of `fields` as offsets, starting from `*offset`.
+static bool write_name_offsets(FILE *fp, struct symbol_table *fields, uint64_t *offset)
+{
+  bool ok = true;
+  for (int id = 0; id < symtab_size(fields); ++id)
+  {
+    ok &= write_all(fp, offset, sizeof(uint64_t));
+    *offset += strlen(symtab_name(fields, id)) + 1;
+  }
+  return ok;
+}
+
+static bool write_names(FILE *fp, struct symbol_table *fields)
+{
+  bool ok = true;
+  for (int id = 0; id < symtab_size(fields); ++id)
+    ok &= write_all(fp, symtab_name(fields, id), strlen(symtab_name(fields, id)) + 1);
+  return ok;
+}
+
+// Write the sections of a snapshot with the records `precs` (ordered by disease),
+// and their indices `by_country`.
+static bool write_snapshot(FILE *fp, struct patient_record **precs, uint64_t *by_country, int n)
+{
+  struct snapshot_header h = { .version = SNAPSHOT_VERSION, .record_size = sizeof(struct snapshot_record) };
+  memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+  h.num_diseases = symtab_size(global.diseases);
+  h.num_countries = symtab_size(global.countries);
+  h.num_records = n;
+
+  for (int id = 0; id < symtab_size(global.diseases); ++id)
+    h.strings_size += strlen(symtab_name(global.diseases, id)) + 1;
+  for (int id = 0; id < symtab_size(global.countries); ++id)
+    h.strings_size += strlen(symtab_name(global.countries, id)) + 1;
+  for (int i = 0; i < n; ++i)
+    h.strings_size += strlen(precs[i]->record_id) + strlen(precs[i]->first_name) + strlen(precs[i]->last_name) + 3;
+
+  h.file_size = sizeof(h) + (h.num_diseases + h.num_countries) * sizeof(uint64_t)
+              + h.num_records * (sizeof(struct snapshot_record) + sizeof(uint64_t)) + h.strings_size;
+
+  bool ok = write_all(fp, &h, sizeof(h));
+
+  uint64_t offset = 0;  // The string pool is written in the order its offsets are handed out.
+  ok &= write_name_offsets(fp, global.diseases, &offset);
+  ok &= write_name_offsets(fp, global.countries, &offset);
+
+  for (int i = 0; i < n; ++i)
+  {
+    struct snapshot_record rec = {
+      .entry_key = precs[i]->entry_date.key,
+      .exit_key  = precs[i]->exit_date.key,
+      .disease   = precs[i]->disease,
+      .country   = precs[i]->country,
+    };
+    rec.record_id  = offset;  offset += strlen(precs[i]->record_id) + 1;
+    rec.first_name = offset;  offset += strlen(precs[i]->first_name) + 1;
+    rec.last_name  = offset;  offset += strlen(precs[i]->last_name) + 1;
+    ok &= write_all(fp, &rec, sizeof(rec));
+  }
+
+  ok &= write_all(fp, by_country, n * sizeof(uint64_t));
+
+  ok &= write_names(fp, global.diseases);
+  ok &= write_names(fp, global.countries);
+  for (int i = 0; i < n; ++i)
+  {
+    ok &= write_all(fp, precs[i]->record_id, strlen(precs[i]->record_id) + 1);
+    ok &= write_all(fp, precs[i]->first_name, strlen(precs[i]->first_name) + 1);
+    ok &= write_all(fp, precs[i]->last_name, strlen(precs[i]->last_name) + 1);
+  }
+  return ok;
+}
+
+// Save every patient record of the database in a binary snapshot at `path`.
+// The snapshot is written to a temporary file first, and renamed to `path` once complete.
+bool save_snapshot(char *path)
+{
+  int n = ht_size(global.patients_ht);
+  struct patient_record **precs = malloc((n ? n : 1) * sizeof(struct patient_record *));
+  struct patient_record **by_country = malloc((n ? n : 1) * sizeof(struct patient_record *));
+  struct record_index *indices = malloc((n ? n : 1) * sizeof(struct record_index));
+  uint64_t *country_order = malloc((n ? n : 1) * sizeof(uint64_t));
+
+  // Records are stored in the order of the disease trees, and the order of the
+  // country trees is stored as indices to them.
+  collect_records(precs, global.disease_ht, global.diseases);
+  collect_records(by_country, global.country_ht, global.countries);
+
+  for (int i = 0; i < n; ++i)
+    indices[i] = (struct record_index){ precs[i], i };
+  qsort(indices, n, sizeof(struct record_index), compare_record_index);
+
+  for (int i = 0; i < n; ++i)
+  {
+    struct record_index key = { .prec = by_country[i] };
+    struct record_index *found = bsearch(&key, indices, n, sizeof(struct record_index), compare_record_index);
+    country_order[i] = found->index;
+  }
+
+  char tmp_path[PATH_MAX];
+  snprintf(tmp_path, PATH_MAX, "%s.tmp", path);
+
+  bool ok = false;
+  FILE *fp = fopen(tmp_path, "wb");
+  if (fp != NULL)
+  {
+    ok = write_snapshot(fp, precs, country_order, n);
+    ok &= (fflush(fp) == 0 && fsync(fileno(fp)) == 0);  // Durable before it replaces `path` (and the log is emptied).
+    ok &= (fclose(fp) == 0);
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok)
+      remove(tmp_path);
+  }
+
+  free(precs);
+  free(by_country);
+  free(indices);
+  free(country_order);
+  return ok;
+}
+
+/* ========================================================================= */
+
+// Sections of a mapped snapshot.
+struct snapshot
+{
+  const struct snapshot_header *header;
+  const uint64_t *disease_names;
+  const uint64_t *country_names;
+  const struct snapshot_record *records;
+  const uint64_t *country_order;
+  const char *strings;
+};
+
+// Check that the header matches the file (of `size` bytes) and locate the sections.
+static bool map_sections(struct snapshot *snap, const char *data, size_t size)
+{
+  const struct snapshot_header *h = (const struct snapshot_header *)data;
+  if (size < sizeof(*h) || memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0
+   || h->version != SNAPSHOT_VERSION || h->record_size != sizeof(struct snapshot_record) || h->file_size != size)
+    return false;
+
+  // Bound the counts first, so the sizes below don't overflow.
+  if (h->num_records > INT_MAX || h->num_records > size || h->strings_size > size)
+    return false;
+
+  uint64_t expected = sizeof(*h) + ((uint64_t)h->num_diseases + h->num_countries) * sizeof(uint64_t)
+                    + h->num_records * (sizeof(struct snapshot_record) + sizeof(uint64_t)) + h->strings_size;
+  if (expected != size)
+    return false;
+
+  snap->header = h;
+  snap->disease_names = (const uint64_t *)(data + sizeof(*h));
+  snap->country_names = snap->disease_names + h->num_diseases;
+  snap->records = (const struct snapshot_record *)(snap->country_names + h->num_countries);
+  snap->country_order = (const uint64_t *)(snap->records + h->num_records);
+  snap->strings = (const char *)(snap->country_order + h->num_records);
+
+  // Every string ends in the pool, as long as its last byte terminates a string.
+  return h->strings_size == 0 || snap->strings[h->strings_size - 1] == '\0';
+}
+
+// Intern the `count` names with `offsets` in `fields`. They must get the IDs they were saved with.
+static bool load_names(struct symbol_table *fields, const uint64_t *offsets, uint32_t count, char *pool, uint64_t pool_size)
+{
+  for (uint32_t id = 0; id < count; ++id)
+    if (offsets[id] >= pool_size || symtab_intern(fields, pool + offsets[id]) != (int)id)
+      return false;
+  return true;
+}
+
+// True if `prec` goes after `prev` in a run ordered by `get_field`, then by entry date.
+static bool in_order(struct patient_record *prev, struct patient_record *prec, int (*get_field)(struct patient_record *))
+{
+  if (prev == NULL || get_field(prev) < get_field(prec))
+    return true;
+  return get_field(prev) == get_field(prec) && compare_prec_entry_dates(prev, prec) < 0;
+}
+
+// Rebuild the database from the sections of `snap`. Returns `false` if they are inconsistent.
+static bool load_sections(struct snapshot *snap)
+{
+  const struct snapshot_header *h = snap->header;
+  int n = h->num_records;
+
+  char *pool = arena_alloc(global.records, h->strings_size + 1);  // Names live with the records.
+  memcpy(pool, snap->strings, h->strings_size);
+
+  if (!load_names(global.diseases, snap->disease_names, h->num_diseases, pool, h->strings_size)
+   || !load_names(global.countries, snap->country_names, h->num_countries, pool, h->strings_size))
+    return false;
+
+  // Size the patient ht for every record up front, so it never grows while loading.
+  // The records were unique when saved, so they are inserted without a lookup.
+  ht_destroy(global.patients_ht);
+  global.patients_ht = ht_create(n / 25 + 50, 50 * MIN_ACCEPTABLE_BUCKET_SIZE, NULL);
+  ht_set_probe_hook(global.patients_ht, counter_hook, &global.stats.patients_probes);
+
+  struct patient_record *precs = arena_alloc(global.records, (n ? n : 1) * sizeof(struct patient_record));
+  struct patient_record **by_disease = malloc((n ? n : 1) * sizeof(struct patient_record *));
+  struct patient_record **by_country = malloc((n ? n : 1) * sizeof(struct patient_record *));
+
+  bool valid = true;
+  uint32_t max_id = 0;
+  for (int i = 0; valid && i < n; ++i)
+  {
+    const struct snapshot_record *rec = &snap->records[i];
+    struct patient_record *prec = &precs[i];
+
+    valid = rec->record_id < h->strings_size && rec->first_name < h->strings_size && rec->last_name < h->strings_size
+         && rec->disease >= 0 && (uint32_t)rec->disease < h->num_diseases
+         && rec->country >= 0 && (uint32_t)rec->country < h->num_countries;
+    if (!valid)
+      break;
+
+    prec->record_id  = pool + rec->record_id;
+    prec->first_name = pool + rec->first_name;
+    prec->last_name  = pool + rec->last_name;
+    prec->disease = rec->disease;
+    prec->country = rec->country;
+    prec->entry_date.key = rec->entry_key;
+    prec->exit_date.key  = rec->exit_key;
+
+    valid = in_order(i ? by_disease[i - 1] : NULL, prec, patient_get_disease);
+    if (!valid)
+      break;
+
+    by_disease[i] = prec;
+    ht_insert(global.patients_ht, prec->record_id, prec);
+    admissions_add(global.admissions, prec->disease, prec->country, &prec->entry_date, &prec->exit_date);
+
+    if (date_id(&prec->entry_date) > max_id)
+      max_id = date_id(&prec->entry_date);
+  }
+
+  for (int i = 0; valid && i < n; ++i)
+  {
+    valid = snap->country_order[i] < (uint64_t)n;
+    if (valid)
+    {
+      by_country[i] = &precs[snap->country_order[i]];
+      valid = in_order(i ? by_country[i - 1] : NULL, by_country[i], patient_get_country);
+    }
+  }
+
+  if (valid)
+  {
+    date_reserve_entry_ids(max_id);  // Entry dates inserted from now on get new IDs.
+    index_sorted_patient_records(by_disease, by_country, n);
+  }
+
+  free(by_disease);
+  free(by_country);
+  return valid;
+}
+
+// Load the database from a snapshot saved by `save_snapshot`, instead of a records file.
+// Returns `false` if the snapshot is missing or invalid.
+bool load_snapshot(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+  {
+    perror("Error opening snapshot");
+    return false;
+  }
+
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  struct snapshot snap;
+  bool valid = data != MAP_FAILED && map_sections(&snap, data, st.st_size) && load_sections(&snap);
+
+  if (data != MAP_FAILED)
+    munmap(data, st.st_size);
+
+  if (!valid)
+    fprintf(stderr, "[ERROR] Invalid snapshot given.\n Exiting.\n");
+  return valid;
+}
+/* ========================================================================= */
@@ -0,0 +1,14 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+
+// Save every patient record of the database in a binary snapshot at `path`.
+// Returns `false` if the file couldn't be written.
+bool save_snapshot(char *path);
+
+// Load the database from a snapshot saved by `save_snapshot`, instead of a records file.
+// Returns `false` if the snapshot is missing or invalid.
+bool load_snapshot(const char *path);
+
+#endif
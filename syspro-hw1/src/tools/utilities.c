@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "avl.h"
 #include "date.h"
@@ -11,30 +12,13 @@
 #include "hash_table.h"
 #include "global_vars.h"
 
-// Default argument for the internal `hidden` patient hash table
-#define DEFAULT_BUCKET_NUM 3000  // in case of empty patient record file.
+// Default initial size for the internal `hidden` patient hash table (it grows as needed)
+#define DEFAULT_BUCKET_NUM 3000
+
+#define RECORD_ARENA_BLOCK (1 << 16)  // Bytes per block of the patient record arena.
                                     
 struct global_vars global;
 
-/* ========================================================================= */
-
-static int records_from_file;
-
-// Count the number of records in the file.
-static void set_line_num(FILE *fp)
-{
-  records_from_file = 0;
-  while (!feof(fp))
-    if (getc(fp) == '\n')
-      ++records_from_file;
-
-  if (fseek(fp, 0L, SEEK_SET))
-  {
-    perror("fseek");
-    exit(EXIT_FAILURE);
-  }
-}
-
 /* ========================================================================= */
 // Destroy function for the contents (avl trees) of disease and country ht.
 static void destroy_avl(void *data)
@@ -43,20 +27,23 @@ static void destroy_avl(void *data)
   avl_destroy(tree);
 }
 
- // For the contents of patient ht.
-static void destroy_precords(void *data)
-{
-  struct patient_record *prec = data;
-  destroy_patient_record(prec);
-}
-
 // Allocate space for the hash tables used by the app.
-void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size)
+void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size, int threads)
 {
-  int pat_bucket_num = records_from_file ? records_from_file : DEFAULT_BUCKET_NUM;
-  global.patients_ht = ht_create(pat_bucket_num / 50 + 50, 50 * MIN_ACCEPTABLE_BUCKET_SIZE, destroy_precords);
+  // Patient records live in the arena, so the patient ht doesn't own them.
+  global.patients_ht = ht_create(DEFAULT_BUCKET_NUM / 50 + 50, 50 * MIN_ACCEPTABLE_BUCKET_SIZE, NULL);
   global.disease_ht = ht_create(dis_ht_entries,  bucket_size, destroy_avl);
   global.country_ht = ht_create(ctry_ht_entries, bucket_size, destroy_avl);
+  global.diseases = symtab_create();
+  global.countries = symtab_create();
+  global.records = arena_create(RECORD_ARENA_BLOCK);
+  global.admissions = admissions_create(global.diseases, global.countries);
+  global.threads = threads;
+
+  ht_set_probe_hook(global.patients_ht, counter_hook, &global.stats.patients_probes);
+  ht_set_probe_hook(global.disease_ht, counter_hook, &global.stats.disease_probes);
+  ht_set_probe_hook(global.country_ht, counter_hook, &global.stats.country_probes);
+  admissions_count_nodes(global.admissions, &global.stats.range_nodes);
 }
 
 void cleanup_structures(void)
@@ -64,19 +51,35 @@ void cleanup_structures(void)
   ht_destroy(global.country_ht);
   ht_destroy(global.disease_ht);
   ht_destroy(global.patients_ht);
+  symtab_destroy(global.diseases);
+  symtab_destroy(global.countries);
+  arena_destroy(global.records);  // Frees every patient record at once.
+  admissions_destroy(global.admissions);
 }
 
 /* ========================================================================= */
 // Returns args read by reference to the pointers given.
-void handle_cmd_line_args(int argc, const char **argv, FILE **fp, int *disease_s, int *country_s, int *bucket_s)
+// Either a records file (-p) or a snapshot (-s) is given: `*fp` is NULL for a snapshot, `*snapshot` NULL for a file.
+// The write-ahead log (-w) is optional: `*wal` is NULL if not given.
+// So is a commands file (-i, "-" for stdin) for batch mode: `*commands` is NULL if not given.
+// The threads of the parallel operations (-t) are the online cores by default.
+void handle_cmd_line_args(int argc, const char **argv, FILE **fp, const char **snapshot, const char **wal, FILE **commands, int *disease_s, int *country_s, int *bucket_s, int *threads)
 {
-  if (argc != 9)
+  if (argc < 9 || argc % 2 == 0)  // Every option is followed by its value.
   {
     fprintf(stderr, "\n> Not enough or excessive arguments given.\n\n\n");
     exit(EXIT_FAILURE);
   }
 
-  const char *pathname;
+  const char *pathname = NULL;
+  *snapshot = NULL;
+  *wal = NULL;
+  *commands = NULL;
+  const char *commands_path = NULL;
+  *fp = NULL;
+
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  *threads = cores < 1 ? 1 : cores > MAX_THREADS ? MAX_THREADS : cores;
 
   for (int i = 1; i < argc; ++i)
   {
@@ -88,6 +91,14 @@ void handle_cmd_line_args(int argc, const char **argv, FILE **fp, int *disease_s
       *country_s = atoi(argv[++i]);
     else if (!strcmp(argv[i], "-p"))
       pathname = argv[++i];
+    else if (!strcmp(argv[i], "-s"))
+      *snapshot = argv[++i];
+    else if (!strcmp(argv[i], "-w"))
+      *wal = argv[++i];
+    else if (!strcmp(argv[i], "-i"))
+      commands_path = argv[++i];
+    else if (!strcmp(argv[i], "-t"))
+      *threads = atoi(argv[++i]);
     else
     {
       fprintf(stderr, "\n> Invalid command line argument option given: %s\n\n\n", argv[i]);
@@ -108,55 +119,36 @@ void handle_cmd_line_args(int argc, const char **argv, FILE **fp, int *disease_s
     exit(EXIT_FAILURE);
   }
 
-  if ((*fp = fopen(pathname, "r")) == NULL)
+  if (*threads < 1 || *threads > MAX_THREADS)
   {
-    perror("Error opening file");
+    fprintf(stderr, "\n> Invalid number of threads given.\n> Please give an integer in [1, %d].\n\n\n", MAX_THREADS);
     exit(EXIT_FAILURE);
   }
-}
 
-/* ========================================================================= */
-
-// Parse a file with patients line by line, and insert every patient to the database.
-// Return `true` if the file doesn't contain duplicate patients, else `false`.
-bool parse_file(FILE *fp)
-{
-  bool valid = true;
-  char *line = NULL;
-  size_t len = 0;
-
-  set_line_num(fp);
-
-  while (getline(&line, &len, fp) != -1)
+  if ((pathname == NULL) == (*snapshot == NULL))
   {
-    char *rec_id = strtok(line, " ");
-    char *first = strtok(NULL, " ");
-    char *last = strtok(NULL, " ");
-    char *disease_id = strtok(NULL, " ");
-    char *country = strtok(NULL, " ");
-    char *entry_dt = strtok(NULL, " ");
-    char *exit_dt = strtok(NULL, " \n");
-
-    struct date d1, d2;     // Make sure the dates are given in order.
-    convert_str_to_date(entry_dt, &d1, DUMMY_BEGIN);
-    convert_str_to_date(exit_dt,  &d2, DUMMY_END);
-    if (compare_dates(&d1, &d2) > 0)
-    {
-      printf("error\n");
-      continue;
-    }
+    fprintf(stderr, "\n> Please give either a patient records file (-p) or a snapshot (-s).\n\n\n");
+    exit(EXIT_FAILURE);
+  }
 
-    if (!insert_patient_record(rec_id, first, last, disease_id, country, entry_dt, exit_dt))
+  if (commands_path != NULL)
+  {
+    *commands = strcmp(commands_path, "-") ? fopen(commands_path, "r") : stdin;
+    if (*commands == NULL)
     {
-      valid = false;
-      fprintf(stderr, "[ERROR] Duplicate patient given in file.\n Exiting.\n");
-      break;
+      perror("Error opening commands file");
+      exit(EXIT_FAILURE);
     }
   }
 
-  free(line);
-  fclose(fp);
+  if (*snapshot != NULL)  // Loaded later, once the structures are set up.
+    return;
 
-  return valid;
+  if ((*fp = fopen(pathname, "r")) == NULL)
+  {
+    perror("Error opening file");
+    exit(EXIT_FAILURE);
+  }
 }
-/* ========================================================================= */
\ No newline at end of file
+
+/* ========================================================================= */
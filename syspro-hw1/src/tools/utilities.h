@@ -2,11 +2,8 @@
 #include <stdio.h>  // FILE
 #include <stdbool.h>
 
-// Returns `false` if the file has duplicate records.
-bool parse_file(FILE *fp);
+void handle_cmd_line_args(int argc, const char **argv, FILE **fp, const char **snapshot, const char **wal, FILE **commands, int *dis, int *ctry, int *b_size, int *threads);
 
-void handle_cmd_line_args(int argc, const char **argv, FILE **fp, int *dis, int *ctry, int *b_size);
-
-void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size);
+void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size, int threads);
 
 void cleanup_structures(void);
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "patients.h"
+#include "wal.h"
+
+// The log is a magic number followed by entries, appended in the order the commands succeeded:
+//
+//   entry header     payload size & checksum
+//   payload          entry type (1 byte), then every field as a NUL terminated string
+//
+// Entries are buffered in memory and written with a single write & fdatasync per group.
+// The interface commits a group when `WAL_GROUP_SIZE` entries are pending, when the oldest
+// pending entry has waited `WAL_GROUP_WINDOW_MS`, before any command that may reflect them,
+// and before waiting for input. The commands are acknowledged only once their group is committed.
+// A crash while writing leaves an incomplete last entry: replay stops there and cuts it off.
+
+#define WAL_MAGIC "DMWAL\0\0\1"   // Version in the last byte.
+#define WAL_MAGIC_SIZE 8
+
+#define WAL_GROUP_SIZE 256        // Most entries per group commit.
+#define WAL_GROUP_WINDOW_MS 10    // Longest an entry waits for its group.
+
+#define WAL_INSERT_FIELDS 7
+#define WAL_EXIT_FIELDS 2
+
+enum wal_entry_type
+{
+  WAL_INSERT = 1,
+  WAL_EXIT,
+};
+
+struct wal_entry_header
+{
+  uint32_t size;       // Bytes of the payload.
+  uint32_t checksum;   // Of the payload.
+};
+
+static struct
+{
+  int fd;                        // -1 if no log is open.
+  char *buffer;                  // Entries not written yet.
+  size_t size;
+  size_t capacity;
+  int pending;                   // Entries in `buffer`.
+  struct timespec first_pending; // When the oldest of them was logged.
+} wal = { .fd = -1 };
+
+/* ========================================================================= */
+
+// FNV-1a.
+static uint32_t checksum(const char *data, size_t size)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i)
+    hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+  return hash;
+}
+
+static long elapsed_ms(const struct timespec *since)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+static void reserve(size_t size)
+{
+  if (wal.size + size <= wal.capacity)
+    return;
+
+  while (wal.size + size > wal.capacity)
+    wal.capacity = wal.capacity ? 2 * wal.capacity : 1 << 16;
+  wal.buffer = realloc(wal.buffer, wal.capacity);
+}
+
+static bool write_all(int fd, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t n = write(fd, data, size);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n == -1)
+      return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+/* ========================================================================= */
+
+// Append an entry of `type` with the `n` fields given to the buffer.
+static void log_entry(enum wal_entry_type type, char **fields, int n)
+{
+  if (wal.fd == -1)
+    return;
+
+  size_t payload = 1;
+  for (int i = 0; i < n; ++i)
+    payload += strlen(fields[i]) + 1;
+
+  reserve(sizeof(struct wal_entry_header) + payload);
+  char *entry = wal.buffer + wal.size;
+  char *p = entry + sizeof(struct wal_entry_header);
+
+  *p++ = type;
+  for (int i = 0; i < n; ++i)
+  {
+    size_t len = strlen(fields[i]) + 1;
+    memcpy(p, fields[i], len);
+    p += len;
+  }
+
+  struct wal_entry_header h = { payload, checksum(entry + sizeof(h), payload) };
+  memcpy(entry, &h, sizeof(h));
+  wal.size += sizeof(h) + payload;
+
+  if (wal.pending++ == 0)
+    clock_gettime(CLOCK_MONOTONIC, &wal.first_pending);
+}
+
+void wal_log_insert(char *rec_id, char *first, char *last, char *disease_id, char *country, char *entry_dt, char *exit_dt)
+{
+  char *fields[WAL_INSERT_FIELDS] = { rec_id, first, last, disease_id, country, entry_dt, exit_dt ? exit_dt : "" };
+  log_entry(WAL_INSERT, fields, WAL_INSERT_FIELDS);
+}
+
+void wal_log_exit(char *rec_id, char *exit_dt)
+{
+  char *fields[WAL_EXIT_FIELDS] = { rec_id, exit_dt };
+  log_entry(WAL_EXIT, fields, WAL_EXIT_FIELDS);
+}
+
+// True if the pending group is full, or its oldest entry has waited long enough. Also true if nothing is pending.
+bool wal_commit_due(void)
+{
+  return wal.pending == 0 || wal.pending >= WAL_GROUP_SIZE || elapsed_ms(&wal.first_pending) >= WAL_GROUP_WINDOW_MS;
+}
+
+// Write & fsync the entries logged since the last commit, as a single group.
+void wal_commit(void)
+{
+  if (wal.fd == -1 || wal.pending == 0)
+    return;
+
+  if (!write_all(wal.fd, wal.buffer, wal.size) || fdatasync(wal.fd) == -1)
+  {
+    perror("Error writing log");
+    exit(EXIT_FAILURE);  // The commands were acknowledged, they can't be dropped silently.
+  }
+  wal.size = 0;
+  wal.pending = 0;
+}
+
+// Empty the log, once its entries are saved in a snapshot. Pending entries are in the snapshot as well.
+void wal_checkpoint(void)
+{
+  if (wal.fd == -1)
+    return;
+
+  wal.size = 0;
+  wal.pending = 0;
+  if (ftruncate(wal.fd, WAL_MAGIC_SIZE) == -1 || fdatasync(wal.fd) == -1)
+    perror("Error truncating log");
+}
+
+void wal_close(void)
+{
+  if (wal.fd == -1)
+    return;
+
+  wal_commit();
+  close(wal.fd);
+  free(wal.buffer);
+  wal.fd = -1;
+  wal.buffer = NULL;
+  wal.capacity = 0;
+}
+
+/* ========================================================================= */
+
+// Split the payload of an entry in its fields. Returns the number of fields, -1 if it isn't terminated.
+static int split_fields(char *payload, uint32_t size, char **fields, int max)
+{
+  if (payload[size - 1] != '\0')
+    return -1;
+
+  int n = 0;
+  for (char *p = payload + 1; p < payload + size && n < max; p += strlen(p) + 1)
+    fields[n++] = p;
+  return n;
+}
+
+// Apply an entry to the database. Returns `false` if it doesn't apply.
+static bool replay_entry(char *payload, uint32_t size)
+{
+  char *f[WAL_INSERT_FIELDS];
+
+  switch (payload[0])
+  {
+    case WAL_INSERT:
+      if (split_fields(payload, size, f, WAL_INSERT_FIELDS) != WAL_INSERT_FIELDS)
+        return false;
+      return insert_patient_record(f[0], f[1], f[2], f[3], f[4], f[5], f[6][0] ? f[6] : NULL);
+
+    case WAL_EXIT:
+      if (split_fields(payload, size, f, WAL_EXIT_FIELDS) != WAL_EXIT_FIELDS)
+        return false;
+      return set_patient_exit(f[0], f[1]) == EXIT_UPDATED;
+
+    default:
+      return false;
+  }
+}
+
+// Replay the complete entries of the log `data`, of `size` bytes.
+// Returns the size of the log up to the last complete entry, 0 if an entry doesn't apply.
+static size_t replay(char *data, size_t size)
+{
+  size_t offset = WAL_MAGIC_SIZE;
+  struct wal_entry_header h;
+
+  while (size - offset >= sizeof(h))
+  {
+    memcpy(&h, data + offset, sizeof(h));
+    char *payload = data + offset + sizeof(h);
+
+    if (h.size == 0 || h.size > size - offset - sizeof(h) || checksum(payload, h.size) != h.checksum)
+      break;  // Incomplete entry, the last one written before a crash.
+
+    if (!replay_entry(payload, h.size))
+      return 0;
+    offset += sizeof(h) + h.size;
+  }
+  return offset;
+}
+
+static char *read_log(int fd, size_t size)
+{
+  char *data = malloc(size ? size : 1);
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t n = pread(fd, data + done, size - done, done);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  return data;
+}
+
+// Replay the write-ahead log at `path` on top of the loaded database, then keep it open for appending.
+// The log is created if missing. Returns `false` if the log doesn't apply to the database.
+bool wal_open(const char *path)
+{
+  int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1)
+  {
+    perror("Error opening log");
+    return false;
+  }
+
+  bool valid = true;
+  if (st.st_size == 0)  // New log.
+    valid = write_all(fd, WAL_MAGIC, WAL_MAGIC_SIZE) && fdatasync(fd) == 0;
+  else
+  {
+    char *data = read_log(fd, st.st_size);
+    size_t end = 0;
+    if (st.st_size >= WAL_MAGIC_SIZE && memcmp(data, WAL_MAGIC, WAL_MAGIC_SIZE) == 0)
+      end = replay(data, st.st_size);
+
+    valid = end > 0;
+    if (valid && end < (size_t)st.st_size)  // Cut off the incomplete entry, so new ones follow complete ones.
+      valid = ftruncate(fd, end) == 0;
+    free(data);
+  }
+
+  if (!valid)
+  {
+    fprintf(stderr, "[ERROR] Invalid log given.\n Exiting.\n");
+    close(fd);
+    return false;
+  }
+
+  wal.fd = fd;
+  return true;
+}
+/* ========================================================================= */
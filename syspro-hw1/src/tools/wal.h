@@ -0,0 +1,30 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <stdbool.h>
+
+// Replay the write-ahead log at `path` on top of the loaded database, then keep it
+// open for appending. The log is created if missing.
+// Returns `false` if the log doesn't apply to the database.
+bool wal_open(const char *path);
+
+// Log a patient record inserted by `/insertPatientRecord` (`exit_dt` may be NULL).
+void wal_log_insert(char *rec_id, char *first, char *last, char *disease_id, char *country, char *entry_dt, char *exit_dt);
+
+// Log an exit date updated by `/recordPatientExit`.
+void wal_log_exit(char *rec_id, char *exit_dt);
+
+// True if the entries logged since the last commit should be committed now: a full group
+// of them is pending, or the oldest has waited for the group window. Also true if none is pending.
+bool wal_commit_due(void);
+
+// Write & fsync the entries logged since the last commit, as a single group.
+void wal_commit(void);
+
+// Empty the log, once its entries are saved in a snapshot.
+void wal_checkpoint(void);
+
+// Commit the pending entries and close the log. Does nothing if no log is open.
+void wal_close(void);
+
+#endif
@@ -19,6 +19,8 @@
 #include "avl.h"
 #include "list.h"
 #include "hash_table.h"
+#include "arena.h"
+#include "symbol_table.h"
 
 // tools
 #include "ipc.h"
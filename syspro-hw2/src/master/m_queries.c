@@ -51,8 +51,11 @@ void q_search_patient(struct worker_stats *w_stats, int num_workers, int buf_siz
 // For every country, print the PID of the worker assigned to its dir.
 void q_list_countries(struct hash_table *ht_workers)
 {
+  struct ht_iter it;
+  ht_iter_init(&it, ht_workers);
+
   struct bucket_entry *entry;
-  while ((entry = ht_traverse(ht_workers)) != NULL)
+  while ((entry = ht_iter_next(&it)) != NULL)
   {
     char *country = entry->key;
     struct worker_stats *worker = entry->data;
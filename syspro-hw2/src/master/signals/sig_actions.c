@@ -62,8 +62,11 @@ static void output_logs(struct hash_table *ht_workers, int succ, int fail)
   int fd = creat(buf, 0666);
   if (fd == -1){perror("creat"); exit(EXIT_FAILURE);}
 
+  struct ht_iter it;
+  ht_iter_init(&it, ht_workers);
+
   struct bucket_entry *entry;
-  while ((entry = ht_traverse(ht_workers)) != NULL)
+  while ((entry = ht_iter_next(&it)) != NULL)
   {
     char *country = entry->key;
 
@@ -169,8 +172,11 @@ void actions_child_term(bool at_setup, struct hash_table *pht_workers, struct wo
 // Assign to worker with pid <new_pid> the countries (DIRs) that belonged to a terminated child, indicated by <index>.
 static void reassign_countries(pid_t new_pid, struct worker_stats *w_stats, struct hash_table *ht_workers, int index, int buf_size)
 {
+  struct ht_iter it;
+  ht_iter_init(&it, ht_workers);
+
   struct bucket_entry *entry;
-  while ((entry = ht_traverse(ht_workers)) != NULL)  // Find every directory assigned to the terminated child.
+  while ((entry = ht_iter_next(&it)) != NULL)  // Find every directory assigned to the terminated child.
   {
     struct worker_stats *worker = entry->data;   // We replaced the terminated pid with the new pid (create_worker).
     if (worker->w_pid != new_pid)                // So, countries are already associated with the new pid.
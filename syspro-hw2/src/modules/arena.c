@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+/* ========================================================================= */
+
+struct arena_block
+{
+  struct arena_block *next;   // Blocks form a list, the most recent first.
+  size_t size;                // Bytes available in `mem`.
+  size_t used;
+  char mem[];
+};
+
+struct arena
+{
+  struct arena_block *head;   // Block we currently allocate from.
+  size_t block_size;
+  size_t total;               // Bytes reserved by every block.
+};
+
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+/* ========================================================================= */
+
+struct arena *arena_create(size_t block_size)
+{
+  struct arena *ar = calloc(1, sizeof(struct arena));
+  ar->block_size = block_size;
+  return ar;
+}
+
+/* ========================================================================= */
+
+static void add_block(struct arena *ar, size_t min_size)
+{
+  size_t size = min_size > ar->block_size ? min_size : ar->block_size;
+
+  struct arena_block *b = malloc(sizeof(struct arena_block) + size);
+  b->size = size;
+  b->used = 0;
+  b->next = ar->head;
+  ar->head = b;
+  ar->total += size;
+}
+
+// Returns `size` bytes, aligned to `align` bytes. The memory lives until `arena_destroy`.
+void *arena_alloc_aligned(struct arena *ar, size_t size, size_t align)
+{
+  struct arena_block *b = ar->head;
+  if (b != NULL)
+  {
+    uintptr_t addr = (uintptr_t)(b->mem + b->used);
+    size_t pad = -addr & (align - 1);
+
+    if (b->used + pad + size <= b->size)  // Fits in the current block.
+    {
+      b->used += pad + size;
+      return (void *)(addr + pad);
+    }
+  }
+
+  add_block(ar, size + align - 1);  // Reserve room for the padding as well.
+  return arena_alloc_aligned(ar, size, align);
+}
+
+// Returns `size` bytes, aligned for any type. The memory lives until `arena_destroy`.
+void *arena_alloc(struct arena *ar, size_t size) {
+  return arena_alloc_aligned(ar, size, ARENA_ALIGN);
+}
+
+// Returns a copy of `str` allocated in the arena. Strings need no alignment, so they are packed.
+char *arena_strdup(struct arena *ar, const char *str)
+{
+  size_t len = strlen(str) + 1;
+  char *copy = arena_alloc_aligned(ar, len, 1);
+  memcpy(copy, str, len);
+  return copy;
+}
+
+/* ========================================================================= */
+
+// Move every block of `src` to `dst` and destroy `src`.
+// The blocks go after the head of `dst`, which keeps allocating from its current block.
+void arena_merge(struct arena *dst, struct arena *src)
+{
+  struct arena_block *last = src->head;
+  if (last != NULL)
+  {
+    while (last->next)
+      last = last->next;
+
+    if (dst->head == NULL)
+      dst->head = src->head;
+    else
+    {
+      last->next = dst->head->next;
+      dst->head->next = src->head;
+    }
+    dst->total += src->total;
+  }
+  free(src);
+}
+
+/* ========================================================================= */
+
+size_t arena_bytes(struct arena *ar) {
+  return ar->total;
+}
+
+void arena_destroy(struct arena *ar)
+{
+  struct arena_block *b = ar->head;
+  while (b)
+  {
+    struct arena_block *next = b->next;
+    free(b);
+    b = next;
+  }
+  free(ar);
+}
+
+/* ========================================================================= */
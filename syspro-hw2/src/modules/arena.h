@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator: memory is handed out sequentially from large blocks
+// and is released all at once, when the arena is destroyed.
+struct arena;
+
+// Create an arena that allocates blocks of (at least) `block_size` bytes.
+struct arena *arena_create(size_t block_size);
+
+// Returns `size` bytes, aligned for any type. The memory lives until `arena_destroy`.
+void *arena_alloc(struct arena *ar, size_t size);
+
+// Same as `arena_alloc`, with the memory aligned to `align` bytes (a power of 2),
+// e.g. 1 for char data, which then packs without padding.
+void *arena_alloc_aligned(struct arena *ar, size_t size, size_t align);
+
+// Returns a copy of `str` allocated in the arena (byte aligned).
+char *arena_strdup(struct arena *ar, const char *str);
+
+// Move every block of `src` to `dst` and destroy `src`.
+// Memory handed out by `src` then lives until `dst` is destroyed.
+void arena_merge(struct arena *dst, struct arena *src);
+
+// Total bytes reserved by the arena's blocks.
+size_t arena_bytes(struct arena *ar);
+
+void arena_destroy(struct arena *ar);
+
+#endif
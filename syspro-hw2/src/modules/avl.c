@@ -1,4 +1,5 @@
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "avl.h"
@@ -6,9 +7,11 @@
 struct avl_node
 {
   int height;
+  int count;  // Number of nodes in the subtree with root this node (order statistics).
   void *data;
   struct avl_node *left;
   struct avl_node *right;
+  struct avl_node *parent;  // NULL for the root. Allows O(1) amortized in-order steps.
 };
 
 struct avl
@@ -48,8 +51,14 @@ static int node_height(struct avl_node *node) {
   return node == NULL ? 0 : node->height;
 }
 
+static int node_count(struct avl_node *node) {
+  return node == NULL ? 0 : node->count;
+}
+
+// Update the height and the subtree count of `node` from its children.
 static void node_update_height(struct avl_node *node) {
   node->height = 1 + MAX_INT(node_height(node->left), node_height(node->right));
+  node->count = 1 + node_count(node->left) + node_count(node->right);
 }
 
 // Rotations: Each function takes as an argument the node that must be rotated
@@ -64,6 +73,11 @@ static struct avl_node *node_rotate_left(struct avl_node *node)
   right_node->left = node;
   node->right = left_subtree;
 
+  right_node->parent = node->parent;  // Fix the parent links of the nodes that moved.
+  node->parent = right_node;
+  if (left_subtree)
+    left_subtree->parent = node;
+
   node_update_height(node);
   node_update_height(right_node);
   
@@ -79,6 +93,11 @@ static struct avl_node *node_rotate_right(struct avl_node *node)
   left_node->right = node;
   node->left = left_right;
 
+  left_node->parent = node->parent;  // Fix the parent links of the nodes that moved.
+  node->parent = left_node;
+  if (left_right)
+    left_right->parent = node;
+
   node_update_height(node);
   node_update_height(left_node);
   
@@ -136,6 +155,7 @@ static struct avl_node *node_create(void *value) {
   struct avl_node *node = calloc(1, sizeof(struct avl_node));
   node->data = value;
   node->height = 1;
+  node->count = 1;
   return node;
 }
 
@@ -150,9 +170,15 @@ static struct avl_node *node_insert(struct avl_node *node, int (*compare)(void *
   int compare_res = compare(value, node->data);
 
   if (compare_res < 0)  // value is lesser than current node's data, so insert left.
-    node->left = node_insert(node->left, compare, value); 
+  {
+    node->left = node_insert(node->left, compare, value);
+    node->left->parent = node;
+  }
   else
+  {
     node->right = node_insert(node->right, compare, value);
+    node->right->parent = node;
+  }
 
   return node_repair_balance(node); // Repair the balance of the tree and return the root.
 }
@@ -162,6 +188,64 @@ void avl_insert(struct avl *tree, void *data)
   if (tree == NULL) return;
   ++tree->size;
   tree->root = node_insert(tree->root, tree->compare_func, data);
+  tree->root->parent = NULL;
+}
+
+/* ========================================================================= */
+
+// Bulk build: merging a batch costs O(size + n), inserting it O(n logsize).
+// Merge when the batch is at least 1/AVL_BULK_RATIO of the tree.
+#define AVL_BULK_RATIO 16
+
+// Link `nodes[lo..hi]`, sorted, into a balanced subtree under `parent`, and return its root.
+static struct avl_node *node_build(struct avl_node **nodes, int lo, int hi, struct avl_node *parent)
+{
+  if (lo > hi)
+    return NULL;
+
+  int mid = lo + (hi - lo) / 2;
+  struct avl_node *node = nodes[mid];
+  node->parent = parent;
+  node->left = node_build(nodes, lo, mid - 1, node);
+  node->right = node_build(nodes, mid + 1, hi, node);
+  node_update_height(node);  // Halves differ by at most 1 node, so the subtree is balanced.
+
+  return node;
+}
+
+void avl_build_sorted(struct avl *tree, void **array, int n)
+{
+  if (tree == NULL || n <= 0)
+    return;
+
+  if ((long)n * AVL_BULK_RATIO < tree->size)  // Small batch, insert it.
+  {
+    for (int i = 0; i < n; ++i)
+      avl_insert(tree, array[i]);
+    return;
+  }
+
+  int total = tree->size + n;
+  struct avl_node **nodes = malloc(total * sizeof(struct avl_node *));
+
+  // Merge the nodes of the tree (in order) with new nodes for the batch.
+  // On ties the tree's nodes go first, as `avl_insert` places equal elements to the right.
+  struct avl_node *curr = avl_first(tree);
+  int i = 0, k = 0;
+  while (curr != NULL || i < n)
+  {
+    if (curr != NULL && (i == n || tree->compare_func(array[i], curr->data) >= 0))
+    {
+      nodes[k++] = curr;
+      curr = avl_next(tree, curr);
+    }
+    else
+      nodes[k++] = node_create(array[i++]);
+  }
+
+  tree->root = node_build(nodes, 0, total - 1, NULL);
+  tree->size = total;
+  free(nodes);
 }
 
 /* ========================================================================= */
@@ -188,6 +272,79 @@ struct avl_node *avl_find_node(struct avl *tree, void *data) {
 
 /* ========================================================================= */
 
+// Returns the first node in the subtree with root `node` that is greater than `value`
+// (or greater than or equal to `value`, if `inclusive` is true). NULL if there is no such node.
+static struct avl_node *node_find_bound(struct avl_node *node, int (*compare)(void *a, void *b), void *value, bool inclusive)
+{
+  struct avl_node *bound = NULL;
+  while (node != NULL)
+  {
+    int compare_res = compare(value, node->data);
+
+    if (compare_res < 0 || (compare_res == 0 && inclusive))
+    {
+      bound = node;       // `node` is a candidate, search for a lesser one on the left.
+      node = node->left;
+    }
+    else
+      node = node->right;
+  }
+
+  return bound;
+}
+
+// Returns the first node that stores data *equal* or *greater* than `data`.
+// Returns NULL if every element of the tree is lesser than `data`.
+struct avl_node *avl_lower_bound(struct avl *tree, void *data) {
+  return tree ? node_find_bound(tree->root, tree->compare_func, data, true) : NULL;
+}
+
+// Returns the first node that stores data *greater* than `data`.
+// Returns NULL if every element of the tree is lesser than or equal to `data`.
+struct avl_node *avl_upper_bound(struct avl *tree, void *data) {
+  return tree ? node_find_bound(tree->root, tree->compare_func, data, false) : NULL;
+}
+
+/* ========================================================================= */
+
+// Returns the number of nodes in the subtree with root `node` that are lesser than `value`
+// (or lesser than or equal to `value`, if `inclusive` is true).
+static int node_rank(struct avl_node *node, int (*compare)(void *a, void *b), void *value, bool inclusive)
+{
+  int rank = 0;
+  while (node != NULL)
+  {
+    int compare_res = compare(value, node->data);
+
+    if (compare_res > 0 || (compare_res == 0 && inclusive))
+    {
+      rank += node_count(node->left) + 1;  // `node` and its left subtree precede `value`.
+      node = node->right;
+    }
+    else
+      node = node->left;
+  }
+
+  return rank;
+}
+
+// Returns the number of elements in the tree that are lesser than `data`. O(logn)
+int avl_rank(struct avl *tree, void *data) {
+  return tree ? node_rank(tree->root, tree->compare_func, data, false) : 0;
+}
+
+// Returns the number of elements `x` in the tree with `from` <= `x` <= `to`. O(logn)
+int avl_count_range(struct avl *tree, void *from, void *to)
+{
+  if (tree == NULL)
+    return 0;
+
+  int count = node_rank(tree->root, tree->compare_func, to, true) - node_rank(tree->root, tree->compare_func, from, false);
+  return count > 0 ? count : 0;  // Empty range if `from` > `to`.
+}
+
+/* ========================================================================= */
+
 // Returns the left-most node of the subtree with root `node`.
 static struct avl_node *node_find_min(struct avl_node *node)
 {
@@ -203,24 +360,53 @@ struct avl_node *avl_first(struct avl *tree) {
 
 /* ========================================================================= */
 
-// Returns the `next` node of node `target`. Searches in the subtree with root `node`.
-// Returns NULL if `target` is the right-most node of the tree.
-static struct avl_node *node_find_next(struct avl_node *node, int (*compare)(void *a, void *b), struct avl_node *target)
+// Returns the right-most node of the subtree with root `node`.
+static struct avl_node *node_find_max(struct avl_node *node)
 {
-  if (node == target) // Found the target, the next node is the min of its right subtree.
-    return node_find_min(node->right);
-
-  if (compare(target->data, node->data) > 0)  // Target is in the right subtree.
-    return node_find_next(node->right, compare, target);
+  return node != NULL && node->right != NULL
+    ? node_find_max(node->right)
+    : node;
+}
 
-  struct avl_node *res = node_find_next(node->left, compare, target); // `target` is in the left subtree.
-  return res == NULL ? node : res;     // If `target` is the right-most node of the left subtree, then the next is its parent, `node`.
+// Returns the last (right-most) node of the AVL tree.
+struct avl_node *avl_last(struct avl *tree) {
+  return tree ? node_find_max(tree->root) : NULL;
 }
 
+/* ========================================================================= */
+
 // Returns the next node of `node` with the order specified by `tree->compare_func`.
 // Returns NULL if `node` is the last (right-most) node of the tree.
-struct avl_node *avl_next(struct avl *tree, struct avl_node *node) {
-  return (tree && node) ? node_find_next(tree->root, tree->compare_func, node) : NULL;
+// Follows the parent links, so a full in-order walk visits every edge twice: O(1) amortized per step.
+struct avl_node *avl_next(struct avl *tree, struct avl_node *node)
+{
+  if (tree == NULL || node == NULL)
+    return NULL;
+
+  if (node->right != NULL)  // The next node is the min of the right subtree.
+    return node_find_min(node->right);
+
+  // Climb until we arrive from a left subtree; that parent is the next node.
+  while (node->parent != NULL && node->parent->right == node)
+    node = node->parent;
+
+  return node->parent;
+}
+
+// Returns the previous node of `node` with the order specified by `tree->compare_func`.
+// Returns NULL if `node` is the first (left-most) node of the tree.
+struct avl_node *avl_prev(struct avl *tree, struct avl_node *node)
+{
+  if (tree == NULL || node == NULL)
+    return NULL;
+
+  if (node->left != NULL)  // The previous node is the max of the left subtree.
+    return node_find_max(node->left);
+
+  while (node->parent != NULL && node->parent->left == node)
+    node = node->parent;
+
+  return node->parent;
 }
 
 /* ========================================================================= */
@@ -251,13 +437,4 @@ void avl_destroy(struct avl *tree)
   }
 }
 
-/* ========================================================================= */
-
-// Sets the compare function of the tree and returns the old compare function.
-avl_cmp_func avl_set_compare_func(struct avl *tree, avl_cmp_func cmp)
-{
-  int (*old_func)(void *, void *) = tree->compare_func;
-  tree->compare_func = cmp;
-  return old_func;
-}
 /* ========================================================================= */
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <stdlib.h>
+
+#include "fenwick.h"
+
+// The tree covers `size` consecutive positions, starting from `base`.
+// Position `base + i - 1` is stored at index `i` of the (1-indexed) array.
+// When a position out of the covered ones is added, the array is rebuilt
+// with (at least) double size, so the rebuilds cost O(1) amortized per addition.
+
+struct fenwick
+{
+  int base;   // Position stored at index 1.
+  int size;   // Number of positions covered, always a power of 2.
+  int *tree;  // tree[i] holds the sum of positions (i - lowbit(i), i]. tree[0] is unused.
+};
+
+#define FW_INIT_SIZE 512
+
+#define LOWBIT(i) ((i) & -(i))
+
+/* ========================================================================= */
+
+struct fenwick *fw_create(void) {
+  return calloc(1, sizeof(struct fenwick));
+}
+
+void fw_destroy(struct fenwick *fw)
+{
+  free(fw->tree);
+  free(fw);
+}
+
+/* ========================================================================= */
+
+// Rebuild the tree to cover `new_size` positions starting from `new_base`,
+// which must include every position covered so far. O(new_size).
+static void rebuild(struct fenwick *fw, int new_base, int new_size)
+{
+  // Turn the tree back into plain counters, by undoing the build below in reverse order.
+  for (int i = fw->size; i >= 1; --i)
+    if (i + LOWBIT(i) <= fw->size)
+      fw->tree[i + LOWBIT(i)] -= fw->tree[i];
+
+  int *tree = calloc(new_size + 1, sizeof(int));
+  int shift = fw->base - new_base;
+  for (int i = 1; i <= fw->size; ++i)
+    tree[i + shift] = fw->tree[i];
+
+  // Build in O(n): every node passes its sum on to its parent.
+  for (int i = 1; i <= new_size; ++i)
+    if (i + LOWBIT(i) <= new_size)
+      tree[i + LOWBIT(i)] += tree[i];
+
+  free(fw->tree);
+  fw->tree = tree;
+  fw->base = new_base;
+  fw->size = new_size;
+}
+
+// Add `delta` to the counter at `pos`.
+void fw_add(struct fenwick *fw, int pos, int delta)
+{
+  if (fw->tree == NULL)  // First addition, center the tree around `pos`.
+  {
+    fw->size = FW_INIT_SIZE;
+    fw->base = pos - FW_INIT_SIZE / 2;
+    fw->tree = calloc(fw->size + 1, sizeof(int));
+  }
+  else if (pos < fw->base || pos >= fw->base + fw->size)  // Grow towards `pos`.
+  {
+    int end = fw->base + fw->size;  // Past the last position covered.
+    int needed = pos < fw->base ? end - pos : pos - fw->base + 1;
+
+    int new_size = fw->size;
+    while (new_size < needed)
+      new_size *= 2;
+
+    rebuild(fw, pos < fw->base ? end - new_size : fw->base, new_size);
+  }
+
+  for (int i = pos - fw->base + 1; i <= fw->size; i += LOWBIT(i))
+    fw->tree[i] += delta;
+}
+
+/* ========================================================================= */
+
+// Returns the sum of the counters at positions <= `pos`.
+static int prefix_sum(struct fenwick *fw, int pos)
+{
+  if (fw->tree == NULL || pos < fw->base)
+    return 0;
+
+  int i = pos - fw->base + 1;
+  if (i > fw->size)
+    i = fw->size;
+
+  int sum = 0;
+  for (; i > 0; i -= LOWBIT(i))
+    sum += fw->tree[i];
+  return sum;
+}
+
+// Returns the sum of the counters at positions [lo, hi].
+int fw_range_sum(struct fenwick *fw, int lo, int hi)
+{
+  if (lo > hi)
+    return 0;
+  return prefix_sum(fw, hi) - prefix_sum(fw, lo - 1);
+}
+
+/* ========================================================================= */
@@ -0,0 +1,25 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+// Interns strings: every distinct string is stored once, and is represented
+// by a small integer ID. IDs are dense, assigned as 0, 1, 2, ... in order of appearance,
+// so they can directly index arrays of `symtab_size` elements.
+struct symbol_table;
+
+struct symbol_table *symtab_create(void);
+
+// Returns the ID of `str`, assigning it a new one if it hasn't been seen before.
+int symtab_intern(struct symbol_table *st, char *str);
+
+// Returns the ID of `str`, or -1 if it hasn't been interned.
+int symtab_lookup(struct symbol_table *st, char *str);
+
+// Returns the shared copy of the string with `id`.
+char *symtab_name(struct symbol_table *st, int id);
+
+// Number of strings interned.
+int symtab_size(struct symbol_table *st);
+
+void symtab_destroy(struct symbol_table *st);
+
+#endif
@@ -1,47 +1,79 @@
 
-#include <limits.h>
+#include <stdatomic.h>
 #include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
 
 #include "date.h"
 #include "patients.h"
 
 /* ========================================================================= */
 
+static inline bool is_digit(unsigned char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Parse a date given as "DD-MM-YYYY" and return it as yyyymmdd.
+// Shorter fields (eg. "1-2-2020") are accepted as well.
+// Returns DATE_NONE if `str` is NULL or doesn't contain a date ("-").
+// Doesn't allocate or modify `str`, so it is safe to call from several threads.
+static uint32_t parse_ymd(const char *str)
+{
+  if (str == NULL)
+    return DATE_NONE;
+
+  const unsigned char *s = (const unsigned char *)str;
+
+  // Fast path: every date in the input files has the fixed format, so the fields are at known offsets.
+  // Anything longer (e.g. a 5-digit year) takes the general path below.
+  if (is_digit(s[0]) && is_digit(s[1]) && s[2] == '-' && is_digit(s[3]) && is_digit(s[4]) && s[5] == '-'
+   && is_digit(s[6]) && is_digit(s[7]) && is_digit(s[8]) && is_digit(s[9]) && s[10] == '\0')
+  {
+    uint32_t day = (s[0] - '0') * 10 + (s[1] - '0');
+    uint32_t month = (s[3] - '0') * 10 + (s[4] - '0');
+    uint32_t year = (s[6] - '0') * 1000 + (s[7] - '0') * 100 + (s[8] - '0') * 10 + (s[9] - '0');
+    return year * 10000 + month * 100 + day;
+  }
+
+  while (*s == '-')  // Skip leading separators.
+    ++s;
+  if (*s == '\0')    // "-" given as a date.
+    return DATE_NONE;
+
+  uint32_t field[3] = { 0, 0, 0 };  // Day, month, year.
+  for (int i = 0; i < 3 && *s; ++i)
+  {
+    while (is_digit(*s))
+      field[i] = field[i] * 10 + (*s++ - '0');
+    while (*s && *s != '-')  // Ignore anything else in the field.
+      ++s;
+    while (*s == '-')
+      ++s;
+  }
+
+  return field[2] * 10000 + field[1] * 100 + field[0];
+}
+
 // Convert a string that contains a date to a struct date and store it in `d`
 // with ID specified from `type`.
 void convert_str_to_date(char *str, struct date *d, enum date_type type)
 {
-  static unsigned long long count = 1;  // Unique identifier.
-  
-  char *buf = NULL;
-  char *token = NULL;
-  if (str)
-  {
-    buf = strdup(str);
-    token = strtok(buf, "-");
-  }
+  static _Atomic uint32_t count = 1;  // Unique identifier, shared by every thread.
 
-  if (token)
+  uint32_t ymd = parse_ymd(str);
+  if (ymd == DATE_NONE)
   {
-    d->active = true;
-    d->day = atoi(token);
-    d->month = atoi(strtok(NULL, "-"));
-    d->year  = atoi(strtok(NULL, "-"));
-    
-    if (type == ENTRY) // entry dates, for actual patient records, have a unique id.
-      d->id = count++;
-    else if (type == DUMMY_BEGIN) // Dummy beginning entry dates have id 0.
-      d->id = 0;
-    else
-      d->id = ULLONG_MAX; // ending dates have id ULLONG_MAX.
+    date_clear(d);  // "-" given as a date.
+    return;
   }
+
+  uint32_t id;
+  if (type == ENTRY) // entry dates, for actual patient records, have a unique id.
+    id = atomic_fetch_add(&count, 1);
+  else if (type == DUMMY_BEGIN) // Dummy beginning entry dates have the least id.
+    id = DATE_ID_MIN;
   else
-    d->active = false;  // "-" given as a date.
+    id = DATE_ID_MAX; // ending dates have the greatest id.
 
-  if (buf)
-    free(buf);
+  d->key = (uint64_t)ymd << 32 | id;
 }
 
 /* ========================================================================= */
@@ -50,8 +82,9 @@ void convert_str_to_date(char *str, struct date *d, enum date_type type)
 // NOTE: `buf` needs to be at least of 12 chars size.
 void convert_date_to_str(char *buf, struct date *d)
 {
-  if (d->active)
-    snprintf(buf, 12, "%02d-%02d-%4d", d->day, d->month, d->year);
+  uint32_t ymd = date_ymd(d);
+  if (ymd != DATE_NONE)  // Bounded fields, so at most "DD-MM-YYYY".
+    snprintf(buf, 12, "%02d-%02d-%4d", (int)(ymd % 100), (int)(ymd / 100 % 100), (int)(ymd / 10000 % 10000));
   else
     snprintf(buf, 2, "-");  
 }
@@ -62,28 +95,8 @@ void convert_date_to_str(char *buf, struct date *d)
 // Returns  1 if a > b
 int compare_dates(void *a, void *b) // Doesn't compare IDs.
 {
-  struct date *d1 = a, *d2 = b;
-
-  if (d2->active == false && d1->active == false)
-    return 0;
-  if (d2->active == false)
-    return -1;
-  if (d1->active == false)
-    return 1;
-  if (d1->year < d2->year)
-    return -1;
-  if (d1->year > d2->year)
-    return 1;
-  if (d1->month < d2->month)
-    return -1;
-  if (d1->month > d2->month)
-    return 1;
-  if (d1->day < d2->day)
-    return -1;
-  if (d1->day > d2->day)
-    return 1;
-
-  return 0;
+  uint32_t d1 = date_ymd(a), d2 = date_ymd(b);
+  return (d1 > d2) - (d1 < d2);
 }
 
 /* ========================================================================= */
@@ -92,25 +105,9 @@ int compare_dates(void *a, void *b) // Doesn't compare IDs.
 // Returns  1 if a > b
 int compare_prec_entry_dates(void *a, void *b) // Also compares IDs.
 {
-  struct patient_record *p1 = a;
-  struct patient_record *p2 = b;
-
-  struct date *d1 = p1->entry_date;
-  struct date *d2 = p2->entry_date;
-
-  int res = compare_dates(d1, d2);
-
-  if (res == 0)
-  {
-    if (d1->id < d2->id)
-      return -1;
-    if (d1->id > d2->id)
-      return 1;
-    
-    return 0;
-  }
-
-  return res;
+  uint64_t k1 = ((struct patient_record *)a)->entry_date.key;
+  uint64_t k2 = ((struct patient_record *)b)->entry_date.key;
+  return (k1 > k2) - (k1 < k2);
 }
 
 /* ========================================================================= */
@@ -119,43 +116,18 @@ int compare_prec_entry_dates(void *a, void *b) // Also compares IDs.
 // Returns  1 if a > b
 int compare_date_strings(const void *s1, const void *s2)
 {
-  char *save;
-  const char *str1 = *(const char **)s1;
-  const char *str2 = *(const char **)s2;
-  char b1[12];
-  char b2[12];
-  strcpy(b1, str1);
-  strcpy(b2, str2);
-
-  int d1 = atoi(strtok_r(b1, "- ", &save));
-  int m1 = atoi(strtok_r(NULL, "- ", &save));
-  int y1 = atoi(strtok_r(NULL, "- ", &save));
-
-  int d2 = atoi(strtok_r(b2, "- ", &save));
-  int m2 = atoi(strtok_r(NULL, "- ", &save));
-  int y2 = atoi(strtok_r(NULL, "- ", &save));
-
-  if (y1 < y2)
-    return -1;
-  if (y1 > y2)
-    return 1;
-  if (m1 < m2)
-    return -1;
-  if (m1 > m2)
-    return 1;
-  if (d1 < d2)
-    return -1;
-  if (d1 > d2)
-    return 1;
-  return 0;
+  uint32_t d1 = parse_ymd(*(const char **)s1);
+  uint32_t d2 = parse_ymd(*(const char **)s2);
+  return (d1 > d2) - (d1 < d2);
 }
 
 /* ========================================================================= */
 
 void print_date(struct date *d)
 {
-  if (d->active)
-    printf("%02d-%02d-%4d", d->day, d->month, d->year);
+  uint32_t ymd = date_ymd(d);
+  if (ymd != DATE_NONE)
+    printf("%02d-%02d-%4d", (int)(ymd % 100), (int)(ymd / 100 % 100), (int)(ymd / 10000));
   else
     printf("-");
 }
@@ -3,6 +3,7 @@
 
 #include "io_files.h"
 #include "file_parse.h"
+#include "patients.h"
 
 
 static char *get_report(char *f_path, char *country, char *date, int *succ, int *fail);
@@ -0,0 +1,32 @@
+#ifndef ADMISSIONS_H
+#define ADMISSIONS_H
+
+#include "date.h"
+
+// Number of patients admitted per day, for every disease and every (disease, country) pair.
+// Diseases & countries are given by their symbol IDs.
+// Each is kept in a Fenwick tree over the day numbers, so the admissions in
+// a range of dates are counted in O(log days), regardless of the patients in range.
+// Exits are kept the same way, per (disease, country) pair.
+struct admissions;
+
+#define ANY_COUNTRY (-1)
+
+struct admissions *admissions_create(void);
+
+// Count a patient with <disease> from <country>, admitted at <entry_date>.
+void admissions_add(struct admissions *adm, int disease, int country, struct date *entry_date);
+
+// Count the exit of a patient with <disease> from <country>, at <exit_date>.
+void admissions_add_exit(struct admissions *adm, int disease, int country, struct date *exit_date);
+
+// Returns the number of patients with <disease> admitted in [d1, d2].
+// If <country> != ANY_COUNTRY, only patients from <country> are counted.
+int admissions_count(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2);
+
+// Returns the number of patients with <disease> from <country> that exited in [d1, d2].
+int admissions_count_exits(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2);
+
+void admissions_destroy(struct admissions *adm);
+
+#endif
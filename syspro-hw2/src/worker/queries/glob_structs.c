@@ -3,43 +3,35 @@
 #include "patients.h"
 #include "glob_structs.h"
 
-// Default argument for the internal `hidden` patient hash table
+// Initial size of the internal `hidden` patient hash table.
+// Every hash table grows on its own as its load factor rises.
 #define DEFAULT_BUCKET_NUM (5000)
 
-struct global_vars global;
-
-/* ========================================================================= */
+#define RECORD_ARENA_BLOCK (1 << 16)  // Bytes per block of the patient record arena.
 
-// Destroy function for the contents (avl trees) of disease and country ht.
-static void destroy_avl(void *data)
-{
-  struct avl *tree = data;
-  avl_destroy(tree);
-}
-
- // For the contents of patient ht.
-static void destroy_precords(void *data)
-{
-  struct patient_record *prec = data;
-  destroy_patient_record(prec);
-}
+struct global_vars global;
 
 /* ========================================================================= */
 
 // Allocate space for the hash tables used by the app.
-void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size)
+void setup_structures(void)
 {
-  global.patients_ht = ht_create(DEFAULT_BUCKET_NUM / 50 + 50, 50 * HT_MIN_ACCEPTABLE_BUCKET_SIZE, destroy_precords);
-  global.disease_ht = ht_create(dis_ht_entries,  bucket_size, destroy_avl);
-  global.country_ht = ht_create(ctry_ht_entries, bucket_size, destroy_avl);
+  // Patient records live in the arena, so the patient ht doesn't own them.
+  global.patients_ht = ht_create(DEFAULT_BUCKET_NUM / 50 + 50, 50 * HT_MIN_ACCEPTABLE_BUCKET_SIZE, NULL);
+  global.diseases = symtab_create();
+  global.countries = symtab_create();
+  global.records = arena_create(RECORD_ARENA_BLOCK);
+  global.admissions = admissions_create();
 }
 
 
 void cleanup_structures(void)
 {
-  ht_destroy(global.country_ht);
-  ht_destroy(global.disease_ht);
   ht_destroy(global.patients_ht);
+  symtab_destroy(global.diseases);
+  symtab_destroy(global.countries);
+  arena_destroy(global.records);  // Frees every patient record at once.
+  admissions_destroy(global.admissions);
 }
 
 /* ========================================================================= */
\ No newline at end of file
@@ -19,13 +19,13 @@ void q_search_patient(char *rec_id, int write_fd, int buf_size)
     return; // Patient not found
 
   char entry_dt[12], exit_dt[12]; // Compose a message with the result
-  convert_date_to_str(entry_dt, prec->entry_date);
-  convert_date_to_str(exit_dt, prec->exit_date);
+  convert_date_to_str(entry_dt, &prec->entry_date);
+  convert_date_to_str(exit_dt, &prec->exit_date);
   if (exit_dt[0] == '-')
     strcat(exit_dt, "-");
 
   char buf[256];
-  snprintf(buf, 256, "%s %s %s %s %d %s %s", rec_id, prec->first_name, prec->last_name, prec->disease_id, prec->age, entry_dt, exit_dt);
+  snprintf(buf, 256, "%s %s %s %s %d %s %s", rec_id, prec->first_name, prec->last_name, symtab_name(global.diseases, prec->disease), prec->age, entry_dt, exit_dt);
   send_message(write_fd, SEARCH_RESULT_SUCCESS, buf, buf_size);
 }
 
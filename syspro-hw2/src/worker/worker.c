@@ -23,7 +23,7 @@ int main(int argc, char *argv[])
   char *writ_p = argv[3];
   char *input_dir = argv[4];
 
-  setup_structures(500, 500, 200);  // Structures needed for queries
+  setup_structures();  // Structures needed for queries
 
   struct list *open_dirs = list_create(free);  // Keep track of open dirs
 
@@ -26,6 +26,8 @@
 #include "avl.h"
 #include "list.h"
 #include "hash_table.h"
+#include "arena.h"
+#include "symbol_table.h"
 
 // comms
 #include "ipc.h"
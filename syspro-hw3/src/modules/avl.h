@@ -2,16 +2,17 @@
 struct avl;
 struct avl_node;
 
-typedef int (*avl_cmp_func)(void *, void *);
-
-// Sets the compare function of the tree and returns the old compare function.
-avl_cmp_func avl_set_compare_func(struct avl *tree, avl_cmp_func cmp);
-
 struct avl *avl_create(int (*compare)(void *a, void *b), void (*destroy_func)(void *data));
 
 int avl_size(struct avl *tree);
 
 void avl_insert(struct avl *tree, void *data);
+
+// Insert the `n` elements of `array`, which are sorted in the order of the tree.
+// An empty tree (or a batch comparable to the tree in size) is rebuilt balanced
+// from the merged sorted sequence, in O(size + n), without any rotation.
+// A small batch is inserted element by element, in O(n logsize).
+void avl_build_sorted(struct avl *tree, void **array, int n);
 void avl_destroy(struct avl *tree);
 
 // Returns the data associated with `node`.
@@ -21,9 +22,33 @@ void *avl_node_value(struct avl_node *node);
 // Returns NULL if `data` wasn't found in the tree.
 struct avl_node *avl_find_node(struct avl *tree, void *data);
 
+// Returns the first node that stores data *equal* or *greater* than `data`.
+// Returns NULL if every element of the tree is lesser than `data`.
+struct avl_node *avl_lower_bound(struct avl *tree, void *data);
+
+// Returns the first node that stores data *greater* than `data`.
+// Returns NULL if every element of the tree is lesser than or equal to `data`.
+struct avl_node *avl_upper_bound(struct avl *tree, void *data);
+
+// Returns the number of elements in the tree that are lesser than `data`. O(logn)
+int avl_rank(struct avl *tree, void *data);
+
+// Returns the number of elements `x` in the tree with `from` <= `x` <= `to`. O(logn)
+int avl_count_range(struct avl *tree, void *from, void *to);
+
 // Returns the first (left-most) node of the AVL tree.
 struct avl_node *avl_first(struct avl *tree);
 
+// Returns the last (right-most) node of the AVL tree.
+struct avl_node *avl_last(struct avl *tree);
+
+// In-order cursor: a node returned by the functions above can be stepped
+// in O(1) amortized time, so iterating k nodes costs O(log n + k).
+
 // Returns the next node of `node`.
 // Returns NULL if `node` is the last (right-most) node of the tree.
-struct avl_node *avl_next(struct avl *tree, struct avl_node *node);
\ No newline at end of file
+struct avl_node *avl_next(struct avl *tree, struct avl_node *node);
+
+// Returns the previous node of `node`.
+// Returns NULL if `node` is the first (left-most) node of the tree.
+struct avl_node *avl_prev(struct avl *tree, struct avl_node *node);
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include <stdlib.h>
+
+#include "arena.h"
+#include "hash_table.h"
+#include "symbol_table.h"
+
+/* ========================================================================= */
+
+struct symbol
+{
+  char *name;
+  int id;
+};
+
+struct symbol_table
+{
+  struct hash_table *ht;  // Associates a string with its symbol.
+  char **names;           // The name of every symbol, indexed by ID.
+  int size;
+  int capacity;
+  struct arena *strings;  // Storage for the symbols & their names.
+};
+
+#define SYMTAB_INIT_CAPACITY 16
+#define SYMTAB_ARENA_BLOCK 4096
+
+/* ========================================================================= */
+
+struct symbol_table *symtab_create(void)
+{
+  struct symbol_table *st = malloc(sizeof(struct symbol_table));
+  st->ht = ht_create(SYMTAB_INIT_CAPACITY, HT_MIN_ACCEPTABLE_BUCKET_SIZE, NULL);
+  st->size = 0;
+  st->capacity = SYMTAB_INIT_CAPACITY;
+  st->names = malloc(st->capacity * sizeof(char *));
+  st->strings = arena_create(SYMTAB_ARENA_BLOCK);
+  return st;
+}
+
+/* ========================================================================= */
+
+// Returns the ID of `str`, assigning it a new one if it hasn't been seen before.
+int symtab_intern(struct symbol_table *st, char *str)
+{
+  struct symbol *sym = ht_search(st->ht, str);
+  if (sym != NULL)
+    return sym->id;
+
+  if (st->size == st->capacity)  // First occurrence, make room for its name.
+  {
+    st->capacity *= 2;
+    st->names = realloc(st->names, st->capacity * sizeof(char *));
+  }
+
+  sym = arena_alloc(st->strings, sizeof(struct symbol));
+  sym->name = arena_strdup(st->strings, str);
+  sym->id = st->size++;
+
+  st->names[sym->id] = sym->name;
+  ht_insert(st->ht, sym->name, sym);
+  return sym->id;
+}
+
+// Returns the ID of `str`, or -1 if it hasn't been interned.
+int symtab_lookup(struct symbol_table *st, char *str)
+{
+  struct symbol *sym = ht_search(st->ht, str);
+  return sym ? sym->id : -1;
+}
+
+/* ========================================================================= */
+
+char *symtab_name(struct symbol_table *st, int id) {
+  return st->names[id];
+}
+
+int symtab_size(struct symbol_table *st) {
+  return st->size;
+}
+
+void symtab_destroy(struct symbol_table *st)
+{
+  ht_destroy(st->ht);
+  arena_destroy(st->strings);
+  free(st->names);
+  free(st);
+}
+
+/* ========================================================================= */
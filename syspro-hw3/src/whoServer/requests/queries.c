@@ -1,6 +1,7 @@
 
 #include "header.h"
 #include "queries.h"
+#include "worker_stats.h"
 
 /* ========================================================================= */
 
@@ -20,7 +21,7 @@ void q_operate(int operation, struct list *results, struct list *l_workers, stru
 
   if (country != NULL)  // Send a message to the worker of this country
   {
-    struct sockaddr_in *wa = ht_search(ht_workers, country);  // Find worker
+    struct sockaddr_in *wa = find_worker(ht_workers, country);  // Find worker
     if (wa == NULL)
     {
       list_insert_first(results, strdup("Country not found."));
@@ -125,7 +126,7 @@ void q_find_topk(char *request, char *result, struct hash_table *ht_workers, int
   strtok_r(NULL, " \n", stok_save);
   char *country = strtok_r(NULL, " \n", stok_save);
 
-  struct sockaddr_in *wa = ht_search(ht_workers, country);  // Find worker
+  struct sockaddr_in *wa = find_worker(ht_workers, country);  // Find worker
   if (wa == NULL)
   {
     strcpy(result, "No recorded cases in this country.");
@@ -5,7 +5,7 @@
 
 // These structures are shared among threads
 static pthread_mutex_t list_mtx  = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t hash_mtx  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t hash_lock = PTHREAD_RWLOCK_INITIALIZER;  // Inserting moves the entries of the ht
 static pthread_mutex_t waddr_mtx = PTHREAD_MUTEX_INITIALIZER;
 
 static void replace_worker_port(int sock, int port, int buf_size, struct hash_table *ht_workers);
@@ -59,13 +59,10 @@ static void upd_worker_file_reports(int sock, int buf_size, struct sockaddr_in *
     char *stok_save;
     char *country = strtok_r(msg.body, "/ ", &stok_save);
 
-    if (ht_search(ht_workers, country) == NULL)
-    {
-      pthread_mutex_lock(&hash_mtx);
-      // Link the country with the worker's connection info
+    pthread_rwlock_wrlock(&hash_lock);
+    if (ht_search(ht_workers, country) == NULL)  // Link the country with the worker's connection info
       ht_insert(ht_workers, country, work_addr);
-      pthread_mutex_unlock(&hash_mtx);
-    }
+    pthread_rwlock_unlock(&hash_lock);
     
     destroy_message(&msg);
   }
@@ -102,7 +99,7 @@ static void replace_worker_port(int sock, int port, int buf_size, struct hash_ta
     char *country = strtok_r(msg.body, "/ ", &stok_save);
 
     // Get the address linked with the dead worker
-    struct sockaddr_in *worker_addr = ht_search(ht_workers, country);
+    struct sockaddr_in *worker_addr = find_worker(ht_workers, country);
     
     pthread_mutex_lock(&waddr_mtx);
     worker_addr->sin_port = htons(port);  // Replace the port
@@ -113,4 +110,15 @@ static void replace_worker_port(int sock, int port, int buf_size, struct hash_ta
   }
 }
 
-/* ========================================================================= */
\ No newline at end of file
+/* ========================================================================= */
+
+struct sockaddr_in *find_worker(struct hash_table *ht_workers, char *country)
+{
+  pthread_rwlock_rdlock(&hash_lock);
+  struct sockaddr_in *worker_addr = ht_search(ht_workers, country);
+  pthread_rwlock_unlock(&hash_lock);
+
+  return worker_addr;
+}
+
+/* ========================================================================= */
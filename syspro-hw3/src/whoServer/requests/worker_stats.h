@@ -4,4 +4,9 @@
 
 // Decide how to handle worker statistics.
 // Either insert a new worker's info into the app structures, or replace a dead one's info with a replacement's.
-void process_worker_stats(int opcode, char *dec_msg, int sock, int buf_size, struct hash_table *ht_workers, struct list *l_workers);
\ No newline at end of file
+void process_worker_stats(int opcode, char *dec_msg, int sock, int buf_size, struct hash_table *ht_workers, struct list *l_workers);
+
+
+// Return the connection info of the worker assigned to <country>, NULL if none.
+// Safe while other threads insert workers in <ht_workers>.
+struct sockaddr_in *find_worker(struct hash_table *ht_workers, char *country);
\ No newline at end of file
@@ -81,8 +81,11 @@ static char *convert_ht_to_str(char *country, char *date, struct hash_table *sta
 
   int total = strlen(country) + strlen(date) + 2;  // Keep track of the next char in <res>
 
+  struct ht_iter it;
+  ht_iter_init(&it, stats_ht);
+
   struct bucket_entry *entry;
-  while ((entry = ht_traverse(stats_ht)) != NULL)
+  while ((entry = ht_iter_next(&it)) != NULL)
   {
     char buf[128];
     char *disease = entry->key;
@@ -4,6 +4,7 @@
 #include "date.h"
 #include "io_files.h"
 #include "file_parse.h"
+#include "patients.h"
 #include "queries.h"
 
 /* ========================================================================= */
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "date.h"
+#include "fenwick.h"
+#include "admissions.h"
+
+/* ========================================================================= */
+
+struct disease_admissions
+{
+  struct fenwick *total;        // Admissions from every country.
+  struct fenwick **by_country;  // Indexed by country ID, NULL if no admissions from it.
+  int num_countries;            // Size of <by_country>.
+  struct fenwick **exits;       // Exits, indexed by country ID, NULL if no exits from it.
+  int num_exit_countries;       // Size of <exits>.
+};
+
+struct admissions
+{
+  struct disease_admissions *diseases;  // Indexed by disease ID.
+  int num_diseases;
+};
+
+/* ========================================================================= */
+
+struct admissions *admissions_create(void) {
+  return calloc(1, sizeof(struct admissions));
+}
+
+void admissions_destroy(struct admissions *adm)
+{
+  for (int i = 0; i < adm->num_diseases; ++i)
+  {
+    struct disease_admissions *dis = &adm->diseases[i];
+    if (dis->total)
+      fw_destroy(dis->total);
+
+    for (int j = 0; j < dis->num_countries; ++j)
+      if (dis->by_country[j])
+        fw_destroy(dis->by_country[j]);
+    free(dis->by_country);
+
+    for (int j = 0; j < dis->num_exit_countries; ++j)
+      if (dis->exits[j])
+        fw_destroy(dis->exits[j]);
+    free(dis->exits);
+  }
+  free(adm->diseases);
+  free(adm);
+}
+
+/* ========================================================================= */
+
+// Grow `*array` of `*size` elements (each of <elem_size> bytes) to fit <index>.
+// New elements are zeroed.
+static void grow_to_fit(void **array, int *size, int index, size_t elem_size)
+{
+  if (index < *size)
+    return;
+
+  int new_size = *size ? *size : 8;
+  while (new_size <= index)
+    new_size *= 2;
+
+  *array = realloc(*array, new_size * elem_size);
+  memset((char *)*array + *size * elem_size, 0, (new_size - *size) * elem_size);
+  *size = new_size;
+}
+
+// Count a patient with <disease> from <country>, admitted at <entry_date>.
+void admissions_add(struct admissions *adm, int disease, int country, struct date *entry_date)
+{
+  grow_to_fit((void **)&adm->diseases, &adm->num_diseases, disease, sizeof(struct disease_admissions));
+  struct disease_admissions *dis = &adm->diseases[disease];
+
+  grow_to_fit((void **)&dis->by_country, &dis->num_countries, country, sizeof(struct fenwick *));
+
+  if (dis->total == NULL)
+    dis->total = fw_create();
+  if (dis->by_country[country] == NULL)
+    dis->by_country[country] = fw_create();
+
+  int day = date_day_index(entry_date);
+  fw_add(dis->total, day, 1);
+  fw_add(dis->by_country[country], day, 1);
+}
+
+// Count the exit of a patient with <disease> from <country>, at <exit_date>.
+void admissions_add_exit(struct admissions *adm, int disease, int country, struct date *exit_date)
+{
+  grow_to_fit((void **)&adm->diseases, &adm->num_diseases, disease, sizeof(struct disease_admissions));
+  struct disease_admissions *dis = &adm->diseases[disease];
+
+  grow_to_fit((void **)&dis->exits, &dis->num_exit_countries, country, sizeof(struct fenwick *));
+  if (dis->exits[country] == NULL)
+    dis->exits[country] = fw_create();
+
+  fw_add(dis->exits[country], date_day_index(exit_date), 1);
+}
+
+/* ========================================================================= */
+
+// Returns the number of patients with <disease> admitted in [d1, d2].
+// If <country> != ANY_COUNTRY, only patients from <country> are counted.
+int admissions_count(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2)
+{
+  if (disease < 0 || disease >= adm->num_diseases)  // No patients with <disease>.
+    return 0;
+
+  struct disease_admissions *dis = &adm->diseases[disease];
+  struct fenwick *fw = dis->total;
+  if (country != ANY_COUNTRY)
+    fw = (country >= 0 && country < dis->num_countries) ? dis->by_country[country] : NULL;
+
+  if (fw == NULL)
+    return 0;
+  return fw_range_sum(fw, date_day_index(d1), date_day_index(d2));
+}
+
+/* ========================================================================= */
+
+// Returns the number of patients with <disease> from <country> that exited in [d1, d2].
+int admissions_count_exits(struct admissions *adm, int disease, int country, struct date *d1, struct date *d2)
+{
+  if (disease < 0 || disease >= adm->num_diseases)
+    return 0;
+
+  struct disease_admissions *dis = &adm->diseases[disease];
+  if (country < 0 || country >= dis->num_exit_countries || dis->exits[country] == NULL)
+    return 0;  // No exits from <country>.
+
+  return fw_range_sum(dis->exits[country], date_day_index(d1), date_day_index(d2));
+}
+
+/* ========================================================================= */
@@ -1,18 +1,23 @@
 #ifndef GLOBAL_H
 #define GLOBAL_H
 
+#include "admissions.h"
+#include "arena.h"
 #include "hash_table.h"
+#include "symbol_table.h"
 
 struct global_vars
 {
-  struct hash_table *disease_ht;   // Disease hash table
-  struct hash_table *country_ht;   // Country hash table
   struct hash_table *patients_ht;  // Patient hash table
+  struct symbol_table *diseases;   // Disease names, interned to IDs
+  struct symbol_table *countries;  // Country names, interned to IDs
+  struct arena *records;           // Patient records & their names
+  struct admissions *admissions;   // Admissions per day, by disease & country
   struct hash_table *ht_ranges;    // topk-AgeRange query
 };
 
 // Allocate space for the hash tables used by the app.
-void setup_structures(int dis_ht_entries, int ctry_ht_entries, int bucket_size);
+void setup_structures(void);
 
 void cleanup_structures(void);
 
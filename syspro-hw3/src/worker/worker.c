@@ -24,7 +24,7 @@ int main(int argc, char *argv[])
   bool is_repl = atoi(argv[4]) ? true : false;
 
   // Structures needed for queries
-  setup_structures(500, 500, 200);
+  setup_structures();
   struct list *countries = list_create(free);  // Keep track of assigned countries
 
   // Worker quits gracefully with SIGINT when *idle* (blocked in accept())